@@ -0,0 +1,70 @@
+/*******************************************************************************
+*
+*  Filename    : EventSkimmer.hpp
+*  Description : Optional event selection evaluated before the output filling
+*  Details     : The selections are evaluated on the branch buffers of a stream
+*                tree after all ntuplizers have run. The buffers are located
+*                through the branch addresses, so any collection registered to
+*                the stream tree can be used. Events failing any selection are
+*                not written. See skimbase in python/Ntuplizer_cfi.py.
+*
+*******************************************************************************/
+#ifndef BPKFRAMEWORK_BPRIMEKIT_EVENTSKIMMER_HPP
+#define BPKFRAMEWORK_BPRIMEKIT_EVENTSKIMMER_HPP
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include "bpkFrameWork/bprimeKit/interface/NtuplizerStats.hpp"
+
+#include <TTree.h>
+#include <string>
+#include <vector>
+
+class EventSkimmer
+{
+public:
+  EventSkimmer( const edm::ParameterSet&, TTree* streamtree );
+
+  // Whether the current content of the stream tree buffers passes all the
+  // selections, always true if no selection is configured.
+  bool Pass();
+
+  // Events seen/stored, in the format of the ntuplizer counters
+  const NtuplizerStats& Stats() const { return _stats; }
+
+private:
+  // Object count and HT requirement on a LepInfo/JetInfo like collection
+  struct ObjectSelection {
+    std::string    collection;
+    const Int_t*   size;
+    const Float_t* pt;
+    const Float_t* eta;
+    const Int_t*   type;// LeptonType, only if a type is required
+    int            objtype;
+    double         minpt;
+    double         maxabseta;
+    int            mincount;
+    double         minht;
+  };
+
+  std::vector<ObjectSelection> _objselectionlist;
+
+  // At least one of the listed EvtInfo.TrgBook entries fired, read from the
+  // packed TrgBookPacked in the compact trigger mode, or from TrgFamily in the
+  // family trigger mode
+  const Char_t*    _trgbook;
+  const UInt_t*    _trgpacked;
+  std::vector<int> _trgidxlist;
+
+  NtuplizerStats _stats;
+
+  bool PassObjects( const ObjectSelection& ) const;
+  bool PassTrigger() const;
+
+  void AddObjectSelection( TTree*, const edm::ParameterSet&, const bool isLepton );
+
+  template<typename T>
+  static const T* GetBuffer( TTree*, const std::string& branchname );
+};
+
+#endif/* end of include guard: BPKFRAMEWORK_BPRIMEKIT_EVENTSKIMMER_HPP */
@@ -13,12 +13,18 @@
 
 #include "DataFormats/Common/interface/TriggerResults.h"
 #include "DataFormats/L1GlobalTrigger/interface/L1GlobalTriggerReadoutRecord.h"
+#include "DataFormats/L1TGlobal/interface/GlobalAlgBlk.h"
 #include "DataFormats/PatCandidates/interface/MET.h"
+#include "DataFormats/Provenance/interface/LuminosityBlockID.h"
+#include "DataFormats/Provenance/interface/ParameterSetID.h"
 #include "HLTrigger/HLTcore/interface/HLTConfigProvider.h"
 #include "SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h"
 #include "SimDataFormats/GeneratorProducts/interface/LHEEventProduct.h"
 #include "SimDataFormats/PileupSummaryInfo/interface/PileupSummaryInfo.h"
 
+#include <map>
+#include <unordered_map>
+
 class EvtGenNtuplizer : public NtuplizerBase
 {
 
@@ -28,12 +34,20 @@ public:
   ~EvtGenNtuplizer ();
 
   void RegisterTree( TTree* );
+  void GetHandles( const edm::Event&, const edm::EventSetup& );
   void Analyze( const edm::Event&, const edm::EventSetup& );
+  void BeginRun( const edm::Run&, const edm::EventSetup& );
+  void FillRunInfo( const edm::Run&, RunInfoBranches& );
+  void FillLumiInfo( const edm::LuminosityBlock&, LumiInfoBranches& );
+  std::string Name() const;
 
 private:
   EvtInfoBranches EvtInfo;
   GenInfoBranches GenInfo;
 
+  // Weight counts of the processed events since the last FillLumiInfo()
+  LumiInfoBranches _lumicounts;
+
   const edm::EDGetToken _rhotoken;
   const edm::EDGetToken _mettoken;
   const edm::EDGetToken _pmettoken;
@@ -46,12 +60,22 @@ private:
   const edm::EDGetToken _genevttoken;
   const edm::EDGetToken _genparticletoken;
   const edm::EDGetToken _gendigitoken;
+  const edm::EDGetToken _l1algtoken;
   const edm::EDGetToken _lhetoken;
 
   const edm::EDGetToken _mettriggertoken;
   const edm::EDGetToken _metbadmutoken;
   const edm::EDGetToken _metbadchadtoken;
 
+  // Writing the packed TrgBookPacked/HLTbitsPacked instead of TrgBook/HLTbits
+  const bool _compacttrigger;
+  // Writing the versionless TrgFamily states
+  const bool _familytrigger;
+  // Writing the HLT path names, indices and prescales only in the run tree
+  const bool _runlevelmenu;
+  // Writing the LHE weights as half precision ratios to the nominal weight
+  const bool _compactlheweights;
+
   edm::Handle<double> _rhohandle;
   edm::Handle<std::vector<pat::MET>> _methandle;
   edm::Handle<std::vector<pat::MET>> _pmethandle;
@@ -59,6 +83,7 @@ private:
   edm::Handle<edm::TriggerResults> _triggerhandle;
   edm::Handle<reco::BeamSpot> _beamspothandle;
   edm::Handle<L1GlobalTriggerReadoutRecord> _recordhandle;
+  edm::Handle<GlobalAlgBlkBxCollection> _l1alghandle;// Stage-2 L1 (2016)
   HLTConfigProvider _hltconfig;
 
   edm::Handle<GenEventInfoProduct> _genevthandle;
@@ -72,11 +97,57 @@ private:
   edm::Handle<bool> _metbadchadhandle;
   edm::Handle<edm::TriggerResults> _mettriggerhandle;
 
+  // Path names of the trigger results, looked up with the handles
+  const edm::TriggerNames* _trgnames;
+  const edm::TriggerNames* _mettrgnames;
+
+  // Booking index -> menu index of the bookings present in the current HLT
+  // menu, and menu index -> booking index (HLTName2enum), rebuilt only when
+  // the TriggerNames parameter set changes.
+  edm::ParameterSetID _triggermenuid;
+  std::vector<std::pair<unsigned, unsigned> > _bookinglist;
+  std::vector<int> _menuname2enum;
+  std::vector<std::pair<unsigned, unsigned> > _familylist;// Family index -> menu index
+
+  // HLT prescales per menu index, cached per prescale column for the current
+  // run. The active column is read once per luminosity block.
+  std::map<unsigned, std::vector<int> > _prescalecache;
+  const std::vector<int>* _prescalelist;
+  unsigned _prescalecolumn;
+  bool _nocolumnwarned;// Missing prescale column already reported (MC)
+
+  // Gen particle -> collection index of the current event, the buckets are
+  // kept between events
+  std::unordered_map<const reco::Candidate*, int> _genindexmap;
+
+  // Stored gen particles, see genSelection in python/Ntuplizer_cfi.py. A
+  // particle is selected if it passes all the criteria, empty lists pass.
+  struct GenSelection {
+    GenSelection( const edm::ParameterSet& );
+    bool Pass( const reco::GenParticle& ) const;
+
+    int              maxsize;
+    std::vector<int> statuslist;
+    std::vector<int> pdgidlist;// Absolute values
+    bool             lastcopy;
+    bool             hardprocess;
+    bool             ancestors;// Also storing all mothers of selected particles
+  };
+
+  const GenSelection _genselection;
+  std::vector<int> _genstoreidx;// Collection index -> GenInfo index, -1 if not stored
+  edm::LuminosityBlockID _prescalelumi;
+
   /*******************************************************************************
   *   Helper private functions
   *******************************************************************************/
   void FillGen( const edm::Event&, const edm::EventSetup& );
+  void SelectGen();
+  int  GenIndex( const reco::Candidate* ) const;
   void FillEvent( const edm::Event&, const edm::EventSetup& );
+  void UpdateBookingList( const edm::TriggerNames& );
+  Char_t TriggerState( const unsigned menuidx ) const;
+  void UpdatePrescaleList( const edm::LuminosityBlockID&, const edm::TriggerNames&, const bool isdata );
 
   /*******************************************************************************
   *   Helper functions for gen info filling
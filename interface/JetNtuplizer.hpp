@@ -16,6 +16,9 @@
 
 #include "CondFormats/JetMETObjects/interface/FactorizedJetCorrector.h"
 #include "CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h"
+#include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+#include "CondFormats/JetMETObjects/interface/JetResolutionObject.h"
+#include "FWCore/Framework/interface/ESHandle.h"
 
 #include "TLorentzVector.h"
 
@@ -27,7 +30,9 @@ public:
   ~JetNtuplizer ();
 
   virtual void RegisterTree( TTree* );
+  virtual void GetHandles( const edm::Event&, const edm::EventSetup& );
   virtual void Analyze( const edm::Event&, const edm::EventSetup& );
+  virtual std::string Name() const;
 
 private:
   JetInfoBranches JetInfo;
@@ -46,10 +51,15 @@ private:
   edm::Handle<std::vector<pat::Jet> > _jethandle;
   edm::Handle<std::vector<pat::Muon> > _muonhandle;
   edm::Handle<std::vector<pat::Jet> > _subjethandle;
+  edm::ESHandle<JetCorrectorParametersCollection> _jetcorparhandle;
+  edm::ESHandle<JME::JetResolutionObject> _jetptreshandle;
+  edm::ESHandle<JME::JetResolutionObject> _jetphireshandle;
+  edm::ESHandle<JME::JetResolutionObject> _jetressfhandle;
   FactorizedJetCorrector* _jetcorrector;
   JetCorrectionUncertainty* _jetunc;
 
   std::vector<std::vector<pat::Muon>::const_iterator> _selectedmuons;
+  bprimeKit::GenMCTagCache _genmctagcache;// Cleared every event
 
   /*******************************************************************************
   *   Jet type parsing
@@ -21,7 +21,9 @@ public:
   ~LeptonNtuplizer ();
 
   virtual void RegisterTree( TTree* );
+  virtual void GetHandles( const edm::Event&, const edm::EventSetup& );
   virtual void Analyze( const edm::Event&, const edm::EventSetup& );
+  virtual std::string Name() const;
 
 private:
   LepInfoBranches LepInfo;
@@ -56,6 +58,7 @@ private:
   edm::Handle<edm::ValueMap<bool> > _electronIDHEEP;
   edm::Handle<std::vector<reco::Vertex> > _vtxhandle;
   edm::Handle<reco::BeamSpot> _beamspothandle;
+  bprimeKit::GenMCTagCache _genmctagcache;// Cleared every event
 
   void FillMuon( const edm::Event&, const edm::EventSetup& );
   void FillElectron( const edm::Event&, const edm::EventSetup& );
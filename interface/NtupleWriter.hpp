@@ -0,0 +1,161 @@
+/*******************************************************************************
+*
+*  Filename    : NtupleWriter.hpp
+*  Description : Job wide output handler shared by all bprimeKit stream
+*                instances
+*  Details     : Every stream owns its own ntuplizers and branch buffers, which
+*                are registered to a private, never filled, stream tree. The
+*                writer holds the single output tree in the TFileService
+*                directory and serializes the filling: the branch addresses of
+*                the output tree are pointed at the buffers of the calling
+*                stream before TTree::Fill() is called.
+*                In the asynchronous mode the filling is done by a dedicated
+*                thread, the caller gets a future to wait on before reusing
+*                the branch buffers. The thread is not part of the TBB pool,
+*                so the job uses one more thread than numberOfThreads.
+*                In the rollover mode the event and run trees are written to
+*                numbered files instead, a new file is started once the size,
+*                event count or luminosity block limit is reached. The old
+*                file is closed right away, its run tree is written once the
+*                run information of all its runs is known, reopening the file
+*                if needed.
+*                The lumi tree and the job wide run tree hold the weight counts
+*                of all the processed events, regardless of the skim selection.
+*
+*******************************************************************************/
+#ifndef BPKFRAMEWORK_BPRIMEKIT_NTUPLEWRITER_HPP
+#define BPKFRAMEWORK_BPRIMEKIT_NTUPLEWRITER_HPP
+
+#include "DataFormats/Provenance/interface/EventID.h"
+#include "DataFormats/Provenance/interface/LuminosityBlockID.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include "bpkFrameWork/bprimeKit/interface/NtuplizerStats.hpp"
+#include "bpkFrameWork/bprimeKit/interface/format.h"
+
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class NtupleWriter
+{
+public:
+  NtupleWriter( const edm::ParameterSet& );
+  ~NtupleWriter();
+
+  // Creating the output trees in the current TFileService directory,
+  // must be called in the (global) beginJob transition.
+  void BeginJob();
+
+  // Printing the summary table and filling the perf tree, must be called in
+  // the (global) endJob transition.
+  void EndJob();
+
+  // Booking the output event tree with the layout of a stream tree. Only the
+  // first call has an effect, all stream trees share the same layout.
+  void Book( TTree* streamtree ) const;
+
+  // Filling the output tree with the buffers of the given stream tree. In the
+  // asynchronous mode the call returns immediately, the buffers must not be
+  // modified until the returned future is ready. Otherwise the returned future
+  // is invalid.
+  std::shared_future<void> Fill( TTree* streamtree, const edm::EventID& ) const;
+
+  // Whether Fill() is asynchronous, streams should then double buffer
+  bool IsAsync() const { return _async; }
+
+  // Filling the run trees with the merged run information. In the asynchronous
+  // mode this is queued after the pending events of the run.
+  void FillRun( const edm::RunNumber_t, const RunInfoBranches& ) const;
+
+  // Filling the lumi tree with the merged luminosity block counts, which are
+  // also summed into the run tree entry of the run. Queued like FillRun().
+  void FillLumi( const LumiInfoBranches& ) const;
+
+  // Adding the ntuplizer counters of a stream, in the ntuplizer list order.
+  void MergeStats( const std::vector<NtuplizerStats>& ) const;
+
+private:
+  // Output settings, see the outputsetting PSet in python/Ntuplizer_cfi.py
+  const int _compression;
+  const Long64_t _autoflush;
+  const bool _async;
+  const Long64_t _rolloversize;
+  const Long64_t _rolloverevents;
+  const bool _rolloverlumi;
+  std::vector<std::pair<std::string, int> > _basketsizes;
+
+  TDirectory* _dir;
+  TTree* _runtree;
+  TTree* _lumitree;
+  TTree* _perftree;
+
+  mutable std::mutex _mutex;
+  mutable TTree* _eventtree;
+  mutable TTree* _lastsource;
+  mutable RunInfoBranches _runinfo;
+  mutable LumiInfoBranches _lumiinfo;
+  mutable std::map<edm::RunNumber_t, LumiInfoBranches> _runcounts;// Summed lumi counts of the open runs
+  mutable std::vector<NtuplizerStats> _statlist;
+  mutable NtuplizerStats _fillstats;
+
+  // Rollover output files, the last one receives the events and is the only
+  // one kept open. Files are dropped from the list once their run tree is
+  // written.
+  struct OutputFile {
+    std::string                  name;
+    TFile*                       file;
+    TDirectory*                  dir;// Same layout as the TFileService file
+    std::set<edm::RunNumber_t>   runlist;// Runs still without run information
+    std::vector<RunInfoBranches> runinfolist;// Completed runs, not yet written
+  };
+  mutable std::vector<OutputFile> _filelist;
+  mutable unsigned _fileindex;
+  mutable Long64_t _fileentries;
+  mutable Long64_t _flushedzipbytes;// Event tree bytes written to the file
+  mutable Long64_t _pendingbytes;// Uncompressed bytes filled since the last flush
+  mutable edm::LuminosityBlockID _lastlumi;
+  std::string _filebase;
+
+  bool IsRollover() const { return _rolloversize > 0 || _rolloverevents > 0 || _rolloverlumi; }
+
+  // Asynchronous filling queue
+  typedef std::packaged_task<void()> FillRequest;
+  mutable std::mutex _queuemutex;
+  mutable std::condition_variable _queuecond;
+  mutable std::deque<FillRequest> _queue;
+  bool _stopfilling;
+  // A plain thread rather than a TBB task: the loop blocks on the queue and
+  // would otherwise hold one of the framework worker threads.
+  std::thread _fillthread;
+
+  void FillTree( TTree* streamtree, const edm::EventID& ) const;
+  void FillRunTrees( const edm::RunNumber_t, const RunInfoBranches& ) const;
+  void FillLumiTree( const LumiInfoBranches& ) const;
+  void Enqueue( FillRequest&& ) const;
+  void FillLoop();
+  void StopFillThread();
+
+  void ConfigureTree( TTree* ) const;
+  void OpenFile() const;
+  bool SizeLimitReached() const;
+  void Rollover() const;
+  void WriteRunTree( OutputFile& ) const;
+  void CloseFile( OutputFile& ) const;
+  void CompleteFile( OutputFile& ) const;
+
+  static void CopyAddresses( TTree* source, TTree* target );
+  static int  CompressionSettings( const std::string& algorithm, const int level );
+};
+
+#endif/* end of include guard: BPKFRAMEWORK_BPRIMEKIT_NTUPLEWRITER_HPP */
@@ -10,9 +10,12 @@
 
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/Run.h"
 #include "FWCore/Framework/interface/ConsumesCollector.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 
+#include "bpkFrameWork/bprimeKit/interface/NtuplizerStats.hpp"
 #include "bpkFrameWork/bprimeKit/interface/bprimeKit.hpp"
 
 #include "TTree.h"
@@ -22,7 +25,8 @@ class NtuplizerBase
 public:
   NtuplizerBase( const edm::ParameterSet& iConfig, bprimeKit* bpk ) :
     _settings( iConfig ),
-    _bpkinstance( bpk )
+    _bpkinstance( bpk ),
+    _branchfilter( GetStringList( iConfig, "keepBranches" ), GetStringList( iConfig, "dropBranches" ) )
   {}
 
   virtual
@@ -40,10 +44,82 @@ public:
   // Pure virtual function to be overloaded
   virtual void RegisterTree( TTree* )                                       = 0;
   virtual void Analyze( const edm::Event&, const edm::EventSetup& )         = 0;
+  virtual std::string Name() const                                          = 0;
+
+  // Reading the event products (and event setup records) used by Analyze.
+  // Called for every ntuplizer in turn before any Analyze call, as Analyze
+  // may run as a concurrent task and must then only use what was read here.
+  virtual void GetHandles( const edm::Event&, const edm::EventSetup& )      = 0;
+
+  // Called at the beginning of every run, before its first event, for caching
+  // run level conditions such as the HLT configuration
+  virtual void BeginRun( const edm::Run&, const edm::EventSetup& ) {}
+
+  // Adding the run level information at the end of every run. The calls of
+  // the streams are serialized, but every stream fills the same object.
+  virtual void FillRunInfo( const edm::Run&, RunInfoBranches& ) {}
+
+  // Adding the counts collected since the previous call to the luminosity
+  // block information, at the end of every luminosity block.
+  virtual void FillLumiInfo( const edm::LuminosityBlock&, LumiInfoBranches& ) {}
+
+  // Instrumented calls of the virtual functions, used by bprimeKit
+  void
+  TimedRegisterTree( TTree* tree )
+  {
+    const StopWatch watch;
+    RegisterTree( tree );
+    _stats.Name          = Name();
+    _stats.RegisterTime    += watch.WallTime();
+    _stats.RegisterCpuTime += watch.CpuTime();
+  }
+
+  void
+  TimedGetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+  {
+    const StopWatch watch;
+    GetHandles( iEvent, iSetup );
+    _stats.WallTime += watch.WallTime();
+    _stats.CpuTime  += watch.CpuTime();
+  }
+
+  void
+  TimedAnalyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+  {
+    const StopWatch watch;
+    Analyze( iEvent, iSetup );
+    _stats.WallTime += watch.WallTime();
+    _stats.CpuTime  += watch.CpuTime();
+    _stats.Calls++;
+  }
+
+  const NtuplizerStats& Stats() const { return _stats; }
+
+protected:
+  // Keep/drop lists of the ntuplizer settings, to be passed to RegisterTree
+  const bpk::BranchFilter& OutputFilter() const { return _branchfilter; }
+
+  // Number of objects read from the input collection and stored in the ntuple
+  void
+  CountObjects( const unsigned seen, const unsigned stored )
+  {
+    _stats.ObjSeen   += seen;
+    _stats.ObjStored += stored;
+  }
 
 private:
   const edm::ParameterSet& _settings;
   bprimeKit*  _bpkinstance;
+  NtuplizerStats _stats;
+  const bpk::BranchFilter _branchfilter;
+
+  static std::vector<std::string>
+  GetStringList( const edm::ParameterSet& iConfig, const std::string& tag )
+  {
+    return iConfig.exists( tag ) ?
+           iConfig.getParameter<std::vector<std::string> >( tag ) :
+           std::vector<std::string>();
+  }
 };
 
 #endif/* end of include guard: BPKFRAMEWORK_BPRIMEKIT_INFONTUPLIZERBASE_HPP */
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*
+*  Filename    : NtuplizerStats.hpp
+*  Description : Timing and object counters collected for each ntuplizer
+*  Details     : The counters are accumulated per stream without locking, and
+*                merged into the NtupleWriter at the end of each stream. The
+*                merged results are printed and stored in the perf tree at the
+*                end of the job.
+*
+*******************************************************************************/
+#ifndef BPKFRAMEWORK_BPRIMEKIT_NTUPLIZERSTATS_HPP
+#define BPKFRAMEWORK_BPRIMEKIT_NTUPLIZERSTATS_HPP
+
+#include <chrono>
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+*   Counters of a single ntuplizer, times are in seconds
+*******************************************************************************/
+class NtuplizerStats
+{
+public:
+  NtuplizerStats( const std::string& name = "" );
+
+  std::string Name;
+  unsigned long long Calls;
+  double WallTime;
+  double CpuTime;
+  double RegisterTime;
+  double RegisterCpuTime;
+  unsigned long long ObjSeen;
+  unsigned long long ObjStored;
+  unsigned long long EvtSeen;// Events passed to/accepted by a selection
+  unsigned long long EvtStored;
+
+  void Merge( const NtuplizerStats& );
+
+  static void PrintTable( std::ostream&, const std::vector<NtuplizerStats>& );
+};
+
+/*******************************************************************************
+*   Wall and thread CPU time elapsed since construction
+*******************************************************************************/
+class StopWatch
+{
+public:
+  StopWatch();
+
+  double WallTime() const;
+  double CpuTime() const;
+
+private:
+  std::chrono::steady_clock::time_point _wallstart;
+  timespec _cpustart;
+};
+
+#endif/* end of include guard: BPKFRAMEWORK_BPRIMEKIT_NTUPLIZERSTATS_HPP */
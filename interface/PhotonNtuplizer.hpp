@@ -24,7 +24,9 @@ public:
   ~PhotonNtuplizer ();
 
   void RegisterTree( TTree* );
+  void GetHandles( const edm::Event&, const edm::EventSetup& );
   void Analyze( const edm::Event&, const edm::EventSetup& );
+  std::string Name() const;
 
 private:
   PhotonInfoBranches PhotonInfo;
@@ -4,7 +4,14 @@
 
 #define N_TRIGGER_BOOKINGS 5148
 
-const std::string TriggerBooking[N_TRIGGER_BOOKINGS] = {
+// Constant table of string literals, no static initialization. It is defined
+// in a single translation unit (src/TriggerBooking.cc), standalone readers
+// define BPK_TRIGGERBOOKING_TABLE before including this header in one of
+// their files.
+extern const char* const TriggerBooking[N_TRIGGER_BOOKINGS];
+
+#ifdef BPK_TRIGGERBOOKING_TABLE
+const char* const TriggerBooking[N_TRIGGER_BOOKINGS] = {
    "AlCa_EcalEtaEBonly_v1",
    "AlCa_EcalEtaEBonly_v1_Prescl",
    "AlCa_EcalEtaEEonly_v1",
@@ -5154,6 +5161,7 @@ const std::string TriggerBooking[N_TRIGGER_BOOKINGS] = {
    "HLT_VBF_DisplacedJet40_VVTightID_DisplacedTrack_v5",
    "HLT_VBF_DisplacedJet40_VVTightID_Hadronic_v5"
 };
+#endif// BPK_TRIGGERBOOKING_TABLE
 
 enum TriggerBitNumber {
    AlCa_EcalEtaEBonly_v1 = 0,
@@ -12,6 +12,11 @@
 
 #include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
 #include "DataFormats/Common/interface/TriggerResults.h"
+#include "DataFormats/Provenance/interface/ParameterSetID.h"
+#include "FWCore/Common/interface/TriggerNames.h"
+
+#include <regex>
+#include <unordered_map>
 
 
 class TriggerNtuplizer : public NtuplizerBase
@@ -22,7 +27,9 @@ public:
   ~TriggerNtuplizer ();
 
   void RegisterTree( TTree* );
+  void GetHandles( const edm::Event&, const edm::EventSetup& );
   void Analyze( const edm::Event&, const edm::EventSetup& );
+  std::string Name() const;
 
 private:
   TrgInfoBranches TrgInfo;
@@ -32,20 +39,39 @@ private:
 
   edm::Handle<edm::TriggerResults> _triggerhandle;
   edm::Handle<std::vector<pat::TriggerObjectStandAlone>> _triggerobjhandle;
+  const edm::TriggerNames* _trgnames;// Path names of the trigger results
 
   // Helper container classes
   std::vector<std::pair<std::string,std::string>> _triggerlist;
 
+  // Path and filter globs of the triggerlist entries, compiled once
+  std::vector<std::pair<std::regex, std::regex> > _matcherlist;
+
+  // Which triggerlist entries a path name or filter label matches. The paths
+  // are resolved for every menu index when the HLT menu changes, the filter
+  // labels on first use, cleared with the menu.
+  struct GlobMatch {
+    std::vector<char> entrylist;
+    bool              any;
+    int               bookingidx;// TriggerBooking index, paths only
+  };
+  edm::ParameterSetID _triggermenuid;
+  std::vector<GlobMatch> _pathmatchlist;// By menu index
+  std::unordered_map<std::string, GlobMatch> _filtercache;
+
+  // Objects with the path names unpacked, reused across events
+  std::vector<pat::TriggerObjectStandAlone> _unpackedobjlist;
+
+  // Matching path names and filter labels of the current object
+  std::vector<const GlobMatch*> _objpathlist;
+  std::vector<const GlobMatch*> _objfilterlist;
+
   /*******************************************************************************
   *   Trigger parsing helper private methods
   *******************************************************************************/
-  static bool TrigObjMatchPathFilter(
-    const pat::TriggerObjectStandAlone&,
-    const std::string& pathglob,
-    std::string&       matchedpath,
-    const std::string& filterglob,
-    std::string&       matchedfilter
-    );
+  const std::vector<pat::TriggerObjectStandAlone>& UnpackedObjects( const edm::TriggerNames& );
+  void UpdatePathMatches( const edm::TriggerNames& );
+  const GlobMatch& FilterMatch( const std::string& );
   static std::string GlobToRegex( const std::string& );
 };
 
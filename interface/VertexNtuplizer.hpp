@@ -21,7 +21,9 @@ public:
   ~VertexNtuplizer ();
 
   void RegisterTree( TTree* );
+  void GetHandles( const edm::Event&, const edm::EventSetup& );
   void Analyze( const edm::Event&, const edm::EventSetup& );
+  std::string Name() const;
 
 private:
   VertexInfoBranches VertexInfo;
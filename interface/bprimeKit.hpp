@@ -20,17 +20,23 @@
 #define __BPRIMEKIT_H__
 
 // ----- ED Analyzer requirements  ----------------------------------------------
-#include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/stream/EDAnalyzer.h"
 #include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
 #include "FWCore/Framework/interface/Run.h"
 
 #include "DataFormats/HepMCCandidate/interface/GenParticle.h"
 #include "DataFormats/PatCandidates/interface/PackedCandidate.h"
 #include "SimDataFormats/GeneratorProducts/interface/LHERunInfoProduct.h"
 
+#include "bpkFrameWork/bprimeKit/interface/EventSkimmer.hpp"
+#include "bpkFrameWork/bprimeKit/interface/NtupleWriter.hpp"
 #include "bpkFrameWork/bprimeKit/interface/format.h"
 #include <TTree.h>
+#include <future>
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 /*******************************************************************************
 *   Forward declaration of NtuplizerBase
@@ -39,13 +45,21 @@ class NtuplizerBase;
 
 /*******************************************************************************
 *   Main ED analyzer class
+*   One instance is created per stream, each with its own ntuplizers and branch
+*   buffers. The output trees are shared through the NtupleWriter global cache,
+*   the run and luminosity block information of all streams is merged in the
+*   summary caches.
 *******************************************************************************/
 
-class bprimeKit : public edm::EDAnalyzer
+class bprimeKit : public edm::stream::EDAnalyzer<
+    edm::GlobalCache<NtupleWriter>,
+    edm::RunSummaryCache<RunInfoBranches>,
+    edm::LuminosityBlockSummaryCache<LumiInfoBranches>
+    >
 {
 public:
   explicit
-  bprimeKit( const edm::ParameterSet& );
+  bprimeKit( const edm::ParameterSet&, const NtupleWriter* );
   ~bprimeKit();
 
   /*******************************************************************************
@@ -62,39 +76,77 @@ public:
 
   static int GetGenMCTag( const reco::GenParticle* );
 
+  // Memoized GetGenMCTag: the tag of every visited ancestor is stored, so later
+  // walks stop at the first known ancestor. Keyed by particle, the cache must
+  // be cleared for every event.
+  typedef std::unordered_map<const reco::Candidate*, int> GenMCTagCache;
+  static int GetGenMCTag( const reco::Candidate*, GenMCTagCache& );
+
+  // Tags of a whole gen collection in collection order, every particle of the
+  // ancestry is visited once
+  static std::vector<int> GetGenMCTags( const std::vector<reco::GenParticle>& );
+
   static int GetTriggerIdx( const std::string& );
+  static int GetTriggerFamilyIdx( const std::string& family );
+
+  /*******************************************************************************
+  *   Global transitions shared by all stream instances
+  *******************************************************************************/
+  static std::unique_ptr<NtupleWriter> initializeGlobalCache( const edm::ParameterSet& );
+  static void globalBeginJob( NtupleWriter* );
+  static void globalEndJob( NtupleWriter* );
+
+  static std::shared_ptr<RunInfoBranches> globalBeginRunSummary(
+    const edm::Run&, const edm::EventSetup&, const RunContext* );
+  static void globalEndRunSummary(
+    const edm::Run&, const edm::EventSetup&, const RunContext*, RunInfoBranches* );
+
+  static std::shared_ptr<LumiInfoBranches> globalBeginLuminosityBlockSummary(
+    const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext* );
+  static void globalEndLuminosityBlockSummary(
+    const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext*, LumiInfoBranches* );
 
 private:
   /*******************************************************************************
   *   Inherited methods
   *******************************************************************************/
-  virtual void beginJob();
-  virtual void analyze( const edm::Event&, const edm::EventSetup& );
-  virtual void endJob();
-  virtual void beginRun( const edm::Run& iRun, const edm::EventSetup& iSetup );
-  virtual void endRun( const edm::Run&, const edm::EventSetup& );
+  virtual void beginStream( edm::StreamID ) override;
+  virtual void endStream() override;
+  virtual void beginRun( const edm::Run&, const edm::EventSetup& ) override;
+  virtual void analyze( const edm::Event&, const edm::EventSetup& ) override;
+  virtual void endRunSummary( const edm::Run&, const edm::EventSetup&, RunInfoBranches* ) const override;
+  virtual void endLuminosityBlockSummary( const edm::LuminosityBlock&, const edm::EventSetup&, LumiInfoBranches* ) const override;
 
-  // ----- RunInfo, See bprimeKit/plugins/bprimeKit_runInfo.cc  -------------------
-  void GetRunObjects( const edm::Run&, const edm::EventSetup& );
-  void FillRunInfo();
+  // ----- RunInfo, See bprimeKit/src/bprimeKit_runInfo.cc  -----------------------
+  void FillRunInfo( const edm::Run&, RunInfoBranches& ) const;
+  void FillLHEWeightInfo( const LHERunInfoProduct&, RunInfoBranches& ) const;
 
   // ----- Ntuple interaction variables  --------------------------------------
-  TTree* BaseTree;
+  // A full set of ntuplizers and their branch buffers. The private stream tree
+  // is only used for holding the branch addresses, never filled or written.
+  // With the asynchronous output two sets are alternated, so one can be
+  // filled by the next event while the other is still being written.
+  struct NtuplizerSet {
+    TTree*                      streamtree;
+    std::vector<NtuplizerBase*> ntuplizerlist;
+    EventSkimmer*               skimmer;// Selection on the filled buffers
+    std::shared_future<void>    pending;// Fill of the output tree in progress
+  };
 
   friend class NtuplizerBase;
-  std::vector<NtuplizerBase*> _ntuplizerlist;
+  std::vector<NtuplizerSet> _ntuplizerset;
+  unsigned _currentset;
+
+  void MakeNtuplizerSet( const edm::ParameterSet& );
+
+  // Running the ntuplizers of an event as concurrent tasks
+  const bool _parallelntuplizers;
 
 
   /*******************************************************************************
   *   Run level info still handled directly by bprimeKit
   *******************************************************************************/
-  TTree* RunTree;
-  RunInfoBranches RunInfo;
   const edm::EDGetToken _lheruntoken;
-  edm::Handle<LHERunInfoProduct> _runinfohandle;
-
-  // Common interfacer for Triggerbooking
-  static std::map<std::string,int> _hltmap;
 
 };
 
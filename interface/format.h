@@ -11,6 +11,15 @@
 //------------------------------  Required libraries  -------------------------------
 #include "TriggerBooking.h"
 #include <TTree.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fnmatch.h>
+#include <set>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 //-------------------------------  Size limitations  --------------------------------
@@ -18,1304 +27,1152 @@
 #define MAX_TRACKS         256
 #define MAX_JETS           128
 #define MAX_PHOTONS        128
-#define MAX_GENS           128
+#define MAX_GENS           256
 #define MAX_LHE            256
 #define MAX_Vertices       256
 #define MAX_BX             128
 #define MAX_TRGOBJS        64
+#define N_TRGBOOK_WORDS    ( ( N_TRIGGER_BOOKINGS + 15 ) / 16 )// 2 bit states
+#define N_HLTBITS_WORDS    ( ( N_TRIGGER_BOOKINGS + 31 ) / 32 )// 1 bit states
+#define MAX_TRGFAMILIES    2048
+#define N_L1_WORDS         2// 128 L1 algorithm bits
+#define N_TT_WORDS         1// 64 technical trigger bits
+#define MAX_HLTPATHS       1024// 2016 menus have ~700 paths
+#define MAX_HLTPRESCALES   ( MAX_HLTPATHS * 32 )// Paths x prescale columns
 
+/*******************************************************************************
+*   Branch field tables
+*
+*   Every branch class is generated from a single field table macro, listing
+*   the fields in the order of the branches in the tree:
+*
+*      SCALAR( type, field, leaftype )
+*      ARRAY ( type, field, size, leaftype )        -- fixed length array
+*      VARRAY( type, field, size, count, leaftype ) -- array with length stored
+*                                                      in the scalar field count
+*      VECTOR( type, field )                        -- std::vector branch, written
+*                                                      from field_w, read to field
+*      STRING( type, field, size )                  -- null terminated string
+*
+*   The table is expanded into the data members and a Visit() method calling
+*   the visitor for every field. RegisterTree(), Register(), Reset() and
+*   FilledBytes() are all implemented as visitors, alternative writers can be
+*   implemented the same way. RegisterTree() optionally takes a BranchFilter
+*   with keep/drop lists, fields not passing it are never booked.
+*
+*******************************************************************************/
+namespace bpk {
 
-class EvtInfoBranches {
+//-----------------------------  Branch reset helpers  ------------------------------
+
+// Variable length array: clearing the entries [0,count] written in the previous
+// event, the extra entry covers objects partially filled at index count and
+// rejected afterwards. The full flag clears the whole array.
+template<typename T, size_t N>
+inline void ResetArray( T (&array)[N], const Int_t& count, const bool full ) {
+   const size_t n = full || count < 0 ? N : std::min( N, (size_t)count + 1 );
+   memset( array, 0x00, n * sizeof( T ) );
+}
+
+// Fixed length array, always cleared completely.
+template<typename T, size_t N>
+inline void ResetArray( T (&array)[N] ) {
+   memset( array, 0x00, sizeof( array ) );
+}
+
+//---------------------------  Trigger state packing  -------------------------------
+
+// TrgBook states in 2 bits: -4 (not in menu), -3 (not run), -2 (not accepted)
+// and +1 (fired). -1 (error) is not reachable, errors are never accepted, and
+// is stored as -2.
+inline UInt_t PackTrgState( const Char_t x ) {
+   return x == 1 ? 3 : x == -2 || x == -1 ? 2 : x == -3 ? 1 : 0;
+}
+
+inline Char_t UnpackTrgState( const UInt_t x ) {
+   static const Char_t statelist[4] = { -4, -3, -2, 1 };
+   return statelist[x & 3];
+}
+
+//-----------------------------  Trigger families  ----------------------------------
+
+// Trigger path name without the version suffixes, ex.
+// HLT_Ele27_WPTight_Gsf_v3 -> HLT_Ele27_WPTight_Gsf. The _Prescl bookings are
+// not menu paths, they fold into the family of their path: HLT_X_v1_Prescl -> HLT_X
+inline std::string TriggerFamily( std::string name ) {
+   static const std::string prescl = "_Prescl";
+   if( name.size() > prescl.size() && name.compare( name.size() - prescl.size(), prescl.size(), prescl ) == 0 ){
+      name.erase( name.size() - prescl.size() );
+   }
+   std::string ans;
+   ans.reserve( name.size() );
+   for( size_t i = 0; i < name.size(); ){
+      if( name.compare( i, 2, "_v" ) == 0 ){
+         size_t j = i + 2;
+         while( j < name.size() && isdigit( (unsigned char)name[j] ) ){ ++j; }
+         if( j > i + 2 && ( j == name.size() || name[j] == '_' ) ){
+            i = j;
+            continue;
+         }
+      }
+      ans.push_back( name[i++] );
+   }
+   return ans;
+}
+
+// Families of the TriggerBooking paths in order of first appearance, the
+// position in the list is the index of the EvtInfo.TrgFamily entry.
+inline const std::vector<std::string>& TriggerFamilyList() {
+   static const std::vector<std::string> familylist = [](){
+      std::vector<std::string> ans;
+      std::set<std::string> known;
+      for( int i = 0; i < N_TRIGGER_BOOKINGS; ++i ){
+         std::string family = TriggerFamily( TriggerBooking[i] );
+         if( known.insert( family ).second ){ ans.push_back( family ); }
+      }
+      return ans;
+   }();
+   return familylist;
+}
+
+//--------------------------  Half precision weights  -------------------------------
+
+// IEEE 754 half precision encoding (11 significant bits, rounded), used for
+// the LHE weight ratios
+inline UShort_t FloatToHalf( const float x ) {
+   uint32_t f;
+   memcpy( &f, &x, sizeof( f ) );
+   const UShort_t sign = ( f >> 16 ) & 0x8000;
+   const int      exp  = int( ( f >> 23 ) & 0xff ) - 127 + 15;
+   uint32_t       mant = f & 0x7fffff;
+
+   if( ( f & 0x7fffffff ) >= 0x7f800000 ){ return sign | 0x7c00 | ( mant ? 0x200 : 0 ); }// Inf, NaN
+   if( exp >= 31 ){ return sign | 0x7c00; }// Overflow
+   if( exp <= 0 ){// Subnormal
+      if( exp < -10 ){ return sign; }
+      mant |= 0x800000;
+      const int shift = 14 - exp;
+      return sign | ( ( mant >> shift ) + ( ( mant >> ( shift - 1 ) ) & 1 ) );
+   }
+   return sign | ( ( ( exp << 10 ) | ( mant >> 13 ) ) + ( ( mant >> 12 ) & 1 ) );
+}
+
+inline float HalfToFloat( const UShort_t h ) {
+   const uint32_t sign = uint32_t( h & 0x8000 ) << 16;
+   const uint32_t exp  = ( h >> 10 ) & 0x1f;
+   const uint32_t mant = h & 0x3ff;
+   uint32_t f;
+
+   if( exp == 0 ){
+      const float x = std::ldexp( float( mant ), -24 );
+      return sign ? -x : x;
+   } else if( exp == 31 ){
+      f = sign | 0x7f800000 | ( mant << 13 );
+   } else {
+      f = sign | ( ( exp - 15 + 127 ) << 23 ) | ( mant << 13 );
+   }
+   float x;
+   memcpy( &x, &f, sizeof( x ) );
+   return x;
+}
+
+//-------------------------------  Branch naming  -----------------------------------
+
+// Branch names and leaf lists built in reused buffers, rather than in a set of
+// temporary strings per branch. The returned pointers are valid until the
+// next call of the same method.
+class BranchNamer {
 public:
-   Int_t RunNo;
-   ULong64_t EvtNo;
-   Int_t BxNo;
-   Int_t LumiNo;
-   Int_t Orbit;
-   Bool_t McIsTZTZ;
-   Bool_t McIsTHTH;
-   Bool_t McIsTZTH;
-   Bool_t McIsTZBW;
-   Bool_t McIsTHBW;
-   Bool_t McIsBWBW;
-   Int_t McFlag;
-   Int_t McSigTag;
-   Int_t McbprimeMode [2];
-   Int_t MctprimeMode [2];
-   Int_t McWMode [4];
-   Int_t McZMode [2];
-   Float_t McbprimeMass [2];
-   Float_t MctprimeMass [2];
-   Float_t MctopMass [2];
-   Float_t McWMass [4];
-   Float_t McZMass [2];
-   Float_t McDauPt [14];
-   Float_t McDauEta [14];
-   Float_t McDauPhi [14];
-   Int_t McDauPdgID [14];
-   Float_t Rho;
-   Float_t RhoPU [2];
-   Float_t SigmaPU [2];
-   Float_t BeamSpotX;
-   Float_t BeamSpotY;
-   Float_t BeamSpotZ;
-   Int_t nBX;
-   Int_t nPU [MAX_BX];
-   Int_t BXPU [MAX_BX];
-   Float_t TrueIT [MAX_BX];
-   Int_t PDFid1;
-   Int_t PDFid2;
-   Float_t PDFx1;
-   Float_t PDFx2;
-   Float_t PDFscale;
-   Float_t PDFv1;
-   Float_t PDFv2;
-   Float_t PFMET;
-   Float_t PFMETType1CorrectedPFMetUnclusteredEnUp;
-   Float_t PFMETType1CorrectedPFMetUnclusteredEnDown;
-   Float_t PFMETPhi;
-   Float_t PFRawMET;
-   Float_t PFRawMETPhi;
-   Float_t PFSumEt;
-   Float_t PFMETSig;
-   Float_t PFMETlongitudinal;
-   Float_t PFMETRealSig;
-   Float_t PFGenMET;
-   Float_t PFGenMETPhi;
-   Float_t PFMETx;
-   Float_t PFMETy;
-   Float_t PuppiMET;
-   Float_t PuppiMETPhi;
-   Float_t PuppiRawMET;
-   Float_t PuppiRawMETPhi;
-   Float_t PuppiSumEt;
-   Float_t PuppiMETSig;
-   Float_t PuppiMETlongitudinal;
-   Float_t PuppiMETRealSig;
-   Float_t PuppiGenMET;
-   Float_t PuppiGenMETPhi;
-   Int_t TrgCount;
-   Int_t nTrgBook;
-   Char_t TrgBook [N_TRIGGER_BOOKINGS];
-   Int_t nHLT;
-   Float_t HighPurityFraction;
-   Int_t NofTracks;
-   Float_t ptHat;
-   Int_t HLTPrescaleFactor [512];
-   Int_t HLTName2enum [512];
-   Bool_t HLTbits [N_TRIGGER_BOOKINGS];
-   Int_t L1 [128];
-   Int_t TT [64];
-
-   void RegisterTree( TTree* root, const std::string& name = "EvtInfo" ) {
-      root->Branch( ( name + ".RunNo" ).c_str(), &RunNo, ( name + "RunNo/I" ).c_str() );
-      root->Branch( ( name + ".EvtNo" ).c_str(), &EvtNo, ( name + "EvtNo/l" ).c_str() );
-      root->Branch( ( name + ".BxNo" ).c_str(), &BxNo, ( name + "BxNo/I" ).c_str() );
-      root->Branch( ( name + ".LumiNo" ).c_str(), &LumiNo, ( name + "LumiNo/I" ).c_str() );
-      root->Branch( ( name + ".Orbit" ).c_str(), &Orbit, ( name + "Orbit/I" ).c_str() );
-      root->Branch( ( name + ".McIsTZTZ" ).c_str(), &McIsTZTZ, ( name + "McIsTZTZ/O" ).c_str() );
-      root->Branch( ( name + ".McIsTHTH" ).c_str(), &McIsTHTH, ( name + "McIsTHTH/O" ).c_str() );
-      root->Branch( ( name + ".McIsTZTH" ).c_str(), &McIsTZTH, ( name + "McIsTZTH/O" ).c_str() );
-      root->Branch( ( name + ".McIsTZBW" ).c_str(), &McIsTZBW, ( name + "McIsTZBW/O" ).c_str() );
-      root->Branch( ( name + ".McIsTHBW" ).c_str(), &McIsTHBW, ( name + "McIsTHBW/O" ).c_str() );
-      root->Branch( ( name + ".McIsBWBW" ).c_str(), &McIsBWBW, ( name + "McIsBWBW/O" ).c_str() );
-      root->Branch( ( name + ".McFlag" ).c_str(), &McFlag, ( name + "McFlag/I" ).c_str() );
-      root->Branch( ( name + ".McSigTag" ).c_str(), &McSigTag, ( name + "McSigTag/I" ).c_str() );
-      root->Branch( ( name + ".McbprimeMode" ).c_str(), McbprimeMode, ( name + ".McbprimeMode[2]/I" ).c_str() );
-      root->Branch( ( name + ".MctprimeMode" ).c_str(), MctprimeMode, ( name + ".MctprimeMode[2]/I" ).c_str() );
-      root->Branch( ( name + ".McWMode" ).c_str(), McWMode, ( name + ".McWMode[4]/I" ).c_str() );
-      root->Branch( ( name + ".McZMode" ).c_str(), McZMode, ( name + ".McZMode[2]/I" ).c_str() );
-      root->Branch( ( name + ".McbprimeMass" ).c_str(), McbprimeMass, ( name + ".McbprimeMass[2]/F" ).c_str() );
-      root->Branch( ( name + ".MctprimeMass" ).c_str(), MctprimeMass, ( name + ".MctprimeMass[2]/F" ).c_str() );
-      root->Branch( ( name + ".MctopMass" ).c_str(), MctopMass, ( name + ".MctopMass[2]/F" ).c_str() );
-      root->Branch( ( name + ".McWMass" ).c_str(), McWMass, ( name + ".McWMass[4]/F" ).c_str() );
-      root->Branch( ( name + ".McZMass" ).c_str(), McZMass, ( name + ".McZMass[2]/F" ).c_str() );
-      root->Branch( ( name + ".McDauPt" ).c_str(), McDauPt, ( name + ".McDauPt[14]/F" ).c_str() );
-      root->Branch( ( name + ".McDauEta" ).c_str(), McDauEta, ( name + ".McDauEta[14]/F" ).c_str() );
-      root->Branch( ( name + ".McDauPhi" ).c_str(), McDauPhi, ( name + ".McDauPhi[14]/F" ).c_str() );
-      root->Branch( ( name + ".McDauPdgID" ).c_str(), McDauPdgID, ( name + ".McDauPdgID[14]/I" ).c_str() );
-      root->Branch( ( name + ".Rho" ).c_str(), &Rho, ( name + "Rho/F" ).c_str() );
-      root->Branch( ( name + ".RhoPU" ).c_str(), RhoPU, ( name + ".RhoPU[2]/F" ).c_str() );
-      root->Branch( ( name + ".SigmaPU" ).c_str(), SigmaPU, ( name + ".SigmaPU[2]/F" ).c_str() );
-      root->Branch( ( name + ".BeamSpotX" ).c_str(), &BeamSpotX, ( name + "BeamSpotX/F" ).c_str() );
-      root->Branch( ( name + ".BeamSpotY" ).c_str(), &BeamSpotY, ( name + "BeamSpotY/F" ).c_str() );
-      root->Branch( ( name + ".BeamSpotZ" ).c_str(), &BeamSpotZ, ( name + "BeamSpotZ/F" ).c_str() );
-      root->Branch( ( name + ".nBX" ).c_str(), &nBX, ( name + "nBX/I" ).c_str() );
-      root->Branch( ( name + ".nPU" ).c_str(), nPU, ( name + ".nPU[" + name + ".nBX]/I" ).c_str() );
-      root->Branch( ( name + ".BXPU" ).c_str(), BXPU, ( name + ".BXPU[" + name + ".nBX]/I" ).c_str() );
-      root->Branch( ( name + ".TrueIT" ).c_str(), TrueIT, ( name + ".TrueIT[" + name + ".nBX]/F" ).c_str() );
-      root->Branch( ( name + ".PDFid1" ).c_str(), &PDFid1, ( name + "PDFid1/I" ).c_str() );
-      root->Branch( ( name + ".PDFid2" ).c_str(), &PDFid2, ( name + "PDFid2/I" ).c_str() );
-      root->Branch( ( name + ".PDFx1" ).c_str(), &PDFx1, ( name + "PDFx1/F" ).c_str() );
-      root->Branch( ( name + ".PDFx2" ).c_str(), &PDFx2, ( name + "PDFx2/F" ).c_str() );
-      root->Branch( ( name + ".PDFscale" ).c_str(), &PDFscale, ( name + "PDFscale/F" ).c_str() );
-      root->Branch( ( name + ".PDFv1" ).c_str(), &PDFv1, ( name + "PDFv1/F" ).c_str() );
-      root->Branch( ( name + ".PDFv2" ).c_str(), &PDFv2, ( name + "PDFv2/F" ).c_str() );
-      root->Branch( ( name + ".PFMET" ).c_str(), &PFMET, ( name + "PFMET/F" ).c_str() );
-      root->Branch( ( name + ".PFMETType1CorrectedPFMetUnclusteredEnUp" ).c_str(), &PFMETType1CorrectedPFMetUnclusteredEnUp, ( name + "PFMETType1CorrectedPFMetUnclusteredEnUp/F" ).c_str() );
-      root->Branch( ( name + ".PFMETType1CorrectedPFMetUnclusteredEnDown" ).c_str(), &PFMETType1CorrectedPFMetUnclusteredEnDown, ( name + "PFMETType1CorrectedPFMetUnclusteredEnDown/F" ).c_str() );
-      root->Branch( ( name + ".PFMETPhi" ).c_str(), &PFMETPhi, ( name + "PFMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".PFRawMET" ).c_str(), &PFRawMET, ( name + "PFRawMET/F" ).c_str() );
-      root->Branch( ( name + ".PFRawMETPhi" ).c_str(), &PFRawMETPhi, ( name + "PFRawMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".PFSumEt" ).c_str(), &PFSumEt, ( name + "PFSumEt/F" ).c_str() );
-      root->Branch( ( name + ".PFMETSig" ).c_str(), &PFMETSig, ( name + "PFMETSig/F" ).c_str() );
-      root->Branch( ( name + ".PFMETlongitudinal" ).c_str(), &PFMETlongitudinal, ( name + "PFMETlongitudinal/F" ).c_str() );
-      root->Branch( ( name + ".PFMETRealSig" ).c_str(), &PFMETRealSig, ( name + "PFMETRealSig/F" ).c_str() );
-      root->Branch( ( name + ".PFGenMET" ).c_str(), &PFGenMET, ( name + "PFGenMET/F" ).c_str() );
-      root->Branch( ( name + ".PFGenMETPhi" ).c_str(), &PFGenMETPhi, ( name + "PFGenMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".PFMETx" ).c_str(), &PFMETx, ( name + "PFMETx/F" ).c_str() );
-      root->Branch( ( name + ".PFMETy" ).c_str(), &PFMETy, ( name + "PFMETy/F" ).c_str() );
-      root->Branch( ( name + ".PuppiMET" ).c_str(), &PuppiMET, ( name + "PuppiMET/F" ).c_str() );
-      root->Branch( ( name + ".PuppiMETPhi" ).c_str(), &PuppiMETPhi, ( name + "PuppiMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".PuppiRawMET" ).c_str(), &PuppiRawMET, ( name + "PuppiRawMET/F" ).c_str() );
-      root->Branch( ( name + ".PuppiRawMETPhi" ).c_str(), &PuppiRawMETPhi, ( name + "PuppiRawMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".PuppiSumEt" ).c_str(), &PuppiSumEt, ( name + "PuppiSumEt/F" ).c_str() );
-      root->Branch( ( name + ".PuppiMETSig" ).c_str(), &PuppiMETSig, ( name + "PuppiMETSig/F" ).c_str() );
-      root->Branch( ( name + ".PuppiMETlongitudinal" ).c_str(), &PuppiMETlongitudinal, ( name + "PuppiMETlongitudinal/F" ).c_str() );
-      root->Branch( ( name + ".PuppiMETRealSig" ).c_str(), &PuppiMETRealSig, ( name + "PuppiMETRealSig/F" ).c_str() );
-      root->Branch( ( name + ".PuppiGenMET" ).c_str(), &PuppiGenMET, ( name + "PuppiGenMET/F" ).c_str() );
-      root->Branch( ( name + ".PuppiGenMETPhi" ).c_str(), &PuppiGenMETPhi, ( name + "PuppiGenMETPhi/F" ).c_str() );
-      root->Branch( ( name + ".TrgCount" ).c_str(), &TrgCount, ( name + "TrgCount/I" ).c_str() );
-      root->Branch( ( name + ".nTrgBook" ).c_str(), &nTrgBook, ( name + "nTrgBook/I" ).c_str() );
-      root->Branch( ( name + ".TrgBook" ).c_str(), TrgBook, ( name + ".TrgBook[" + name + ".nTrgBook]/C" ).c_str() );
-      root->Branch( ( name + ".nHLT" ).c_str(), &nHLT, ( name + "nHLT/I" ).c_str() );
-      root->Branch( ( name + ".HighPurityFraction" ).c_str(), &HighPurityFraction, ( name + "HighPurityFraction/F" ).c_str() );
-      root->Branch( ( name + ".NofTracks" ).c_str(), &NofTracks, ( name + "NofTracks/I" ).c_str() );
-      root->Branch( ( name + ".ptHat" ).c_str(), &ptHat, ( name + "ptHat/F" ).c_str() );
-      root->Branch( ( name + ".HLTPrescaleFactor" ).c_str(), HLTPrescaleFactor, ( name + ".HLTPrescaleFactor[" + name + ".nHLT]/I" ).c_str() );
-      root->Branch( ( name + ".HLTName2enum" ).c_str(), HLTName2enum, ( name + ".HLTName2enum[" + name + ".nHLT]/I" ).c_str() );
-      root->Branch( ( name + ".HLTbits" ).c_str(), HLTbits, ( name + ".HLTbits[" + name + ".nHLT]/O" ).c_str() );
-      root->Branch( ( name + ".L1" ).c_str(), L1, ( name + ".L1[128]/I" ).c_str() );
-      root->Branch( ( name + ".TT" ).c_str(), TT, ( name + ".TT[64]/I" ).c_str() );
+   explicit BranchNamer( const std::string& prefix ) : _prefix( prefix ) {}
+
+   const char* Name( const char* field ) {
+      _name.assign( _prefix ).append( 1, '.' ).append( field );
+      return _name.c_str();
+   }
+
+   // Scalars: leaf name without the dot, as in the original format
+   const char* Leaf( const char* field, const char* type ) {
+      _leaf.assign( _prefix ).append( field ).append( 1, '/' ).append( type );
+      return _leaf.c_str();
+   }
+
+   const char* Leaf( const char* field, const size_t size, const char* type ) {
+      _leaf.assign( _prefix ).append( 1, '.' ).append( field ).append( 1, '[' );
+      _leaf.append( std::to_string( size ) ).append( "]/" ).append( type );
+      return _leaf.c_str();
    }
 
-   void Register( TTree* root, const std::string& name = "EvtInfo" ) {
-      root->SetBranchAddress( ( name + ".RunNo" ).c_str() , &RunNo );
-      root->SetBranchAddress( ( name + ".EvtNo" ).c_str() , &EvtNo );
-      root->SetBranchAddress( ( name + ".BxNo" ).c_str() , &BxNo );
-      root->SetBranchAddress( ( name + ".LumiNo" ).c_str() , &LumiNo );
-      root->SetBranchAddress( ( name + ".Orbit" ).c_str() , &Orbit );
-      root->SetBranchAddress( ( name + ".McIsTZTZ" ).c_str() , &McIsTZTZ );
-      root->SetBranchAddress( ( name + ".McIsTHTH" ).c_str() , &McIsTHTH );
-      root->SetBranchAddress( ( name + ".McIsTZTH" ).c_str() , &McIsTZTH );
-      root->SetBranchAddress( ( name + ".McIsTZBW" ).c_str() , &McIsTZBW );
-      root->SetBranchAddress( ( name + ".McIsTHBW" ).c_str() , &McIsTHBW );
-      root->SetBranchAddress( ( name + ".McIsBWBW" ).c_str() , &McIsBWBW );
-      root->SetBranchAddress( ( name + ".McFlag" ).c_str() , &McFlag );
-      root->SetBranchAddress( ( name + ".McSigTag" ).c_str() , &McSigTag );
-      root->SetBranchAddress( ( name + ".McbprimeMode" ).c_str() , McbprimeMode );
-      root->SetBranchAddress( ( name + ".MctprimeMode" ).c_str() , MctprimeMode );
-      root->SetBranchAddress( ( name + ".McWMode" ).c_str() , McWMode );
-      root->SetBranchAddress( ( name + ".McZMode" ).c_str() , McZMode );
-      root->SetBranchAddress( ( name + ".McbprimeMass" ).c_str() , McbprimeMass );
-      root->SetBranchAddress( ( name + ".MctprimeMass" ).c_str() , MctprimeMass );
-      root->SetBranchAddress( ( name + ".MctopMass" ).c_str() , MctopMass );
-      root->SetBranchAddress( ( name + ".McWMass" ).c_str() , McWMass );
-      root->SetBranchAddress( ( name + ".McZMass" ).c_str() , McZMass );
-      root->SetBranchAddress( ( name + ".McDauPt" ).c_str() , McDauPt );
-      root->SetBranchAddress( ( name + ".McDauEta" ).c_str() , McDauEta );
-      root->SetBranchAddress( ( name + ".McDauPhi" ).c_str() , McDauPhi );
-      root->SetBranchAddress( ( name + ".McDauPdgID" ).c_str() , McDauPdgID );
-      root->SetBranchAddress( ( name + ".Rho" ).c_str() , &Rho );
-      root->SetBranchAddress( ( name + ".RhoPU" ).c_str() , RhoPU );
-      root->SetBranchAddress( ( name + ".SigmaPU" ).c_str() , SigmaPU );
-      root->SetBranchAddress( ( name + ".BeamSpotX" ).c_str() , &BeamSpotX );
-      root->SetBranchAddress( ( name + ".BeamSpotY" ).c_str() , &BeamSpotY );
-      root->SetBranchAddress( ( name + ".BeamSpotZ" ).c_str() , &BeamSpotZ );
-      root->SetBranchAddress( ( name + ".nBX" ).c_str() , &nBX );
-      root->SetBranchAddress( ( name + ".nPU" ).c_str() , nPU );
-      root->SetBranchAddress( ( name + ".BXPU" ).c_str() , BXPU );
-      root->SetBranchAddress( ( name + ".TrueIT" ).c_str() , TrueIT );
-      root->SetBranchAddress( ( name + ".PDFid1" ).c_str() , &PDFid1 );
-      root->SetBranchAddress( ( name + ".PDFid2" ).c_str() , &PDFid2 );
-      root->SetBranchAddress( ( name + ".PDFx1" ).c_str() , &PDFx1 );
-      root->SetBranchAddress( ( name + ".PDFx2" ).c_str() , &PDFx2 );
-      root->SetBranchAddress( ( name + ".PDFscale" ).c_str() , &PDFscale );
-      root->SetBranchAddress( ( name + ".PDFv1" ).c_str() , &PDFv1 );
-      root->SetBranchAddress( ( name + ".PDFv2" ).c_str() , &PDFv2 );
-      root->SetBranchAddress( ( name + ".PFMET" ).c_str() , &PFMET );
-      root->SetBranchAddress( ( name + ".PFMETType1CorrectedPFMetUnclusteredEnUp" ).c_str() , &PFMETType1CorrectedPFMetUnclusteredEnUp );
-      root->SetBranchAddress( ( name + ".PFMETType1CorrectedPFMetUnclusteredEnDown" ).c_str() , &PFMETType1CorrectedPFMetUnclusteredEnDown );
-      root->SetBranchAddress( ( name + ".PFMETPhi" ).c_str() , &PFMETPhi );
-      root->SetBranchAddress( ( name + ".PFRawMET" ).c_str() , &PFRawMET );
-      root->SetBranchAddress( ( name + ".PFRawMETPhi" ).c_str() , &PFRawMETPhi );
-      root->SetBranchAddress( ( name + ".PFSumEt" ).c_str() , &PFSumEt );
-      root->SetBranchAddress( ( name + ".PFMETSig" ).c_str() , &PFMETSig );
-      root->SetBranchAddress( ( name + ".PFMETlongitudinal" ).c_str() , &PFMETlongitudinal );
-      root->SetBranchAddress( ( name + ".PFMETRealSig" ).c_str() , &PFMETRealSig );
-      root->SetBranchAddress( ( name + ".PFGenMET" ).c_str() , &PFGenMET );
-      root->SetBranchAddress( ( name + ".PFGenMETPhi" ).c_str() , &PFGenMETPhi );
-      root->SetBranchAddress( ( name + ".PFMETx" ).c_str() , &PFMETx );
-      root->SetBranchAddress( ( name + ".PFMETy" ).c_str() , &PFMETy );
-      root->SetBranchAddress( ( name + ".PuppiMET" ).c_str() , &PuppiMET );
-      root->SetBranchAddress( ( name + ".PuppiMETPhi" ).c_str() , &PuppiMETPhi );
-      root->SetBranchAddress( ( name + ".PuppiRawMET" ).c_str() , &PuppiRawMET );
-      root->SetBranchAddress( ( name + ".PuppiRawMETPhi" ).c_str() , &PuppiRawMETPhi );
-      root->SetBranchAddress( ( name + ".PuppiSumEt" ).c_str() , &PuppiSumEt );
-      root->SetBranchAddress( ( name + ".PuppiMETSig" ).c_str() , &PuppiMETSig );
-      root->SetBranchAddress( ( name + ".PuppiMETlongitudinal" ).c_str() , &PuppiMETlongitudinal );
-      root->SetBranchAddress( ( name + ".PuppiMETRealSig" ).c_str() , &PuppiMETRealSig );
-      root->SetBranchAddress( ( name + ".PuppiGenMET" ).c_str() , &PuppiGenMET );
-      root->SetBranchAddress( ( name + ".PuppiGenMETPhi" ).c_str() , &PuppiGenMETPhi );
-      root->SetBranchAddress( ( name + ".TrgCount" ).c_str() , &TrgCount );
-      root->SetBranchAddress( ( name + ".nTrgBook" ).c_str() , &nTrgBook );
-      root->SetBranchAddress( ( name + ".TrgBook" ).c_str() , TrgBook );
-      root->SetBranchAddress( ( name + ".nHLT" ).c_str() , &nHLT );
-      root->SetBranchAddress( ( name + ".HighPurityFraction" ).c_str() , &HighPurityFraction );
-      root->SetBranchAddress( ( name + ".NofTracks" ).c_str() , &NofTracks );
-      root->SetBranchAddress( ( name + ".ptHat" ).c_str() , &ptHat );
-      root->SetBranchAddress( ( name + ".HLTPrescaleFactor" ).c_str() , HLTPrescaleFactor );
-      root->SetBranchAddress( ( name + ".HLTName2enum" ).c_str() , HLTName2enum );
-      root->SetBranchAddress( ( name + ".HLTbits" ).c_str() , HLTbits );
-      root->SetBranchAddress( ( name + ".L1" ).c_str() , L1 );
-      root->SetBranchAddress( ( name + ".TT" ).c_str() , TT );
+   const char* Leaf( const char* field, const char* count, const char* type ) {
+      _leaf.assign( _prefix ).append( 1, '.' ).append( field ).append( 1, '[' );
+      _leaf.append( _prefix ).append( 1, '.' ).append( count ).append( "]/" ).append( type );
+      return _leaf.c_str();
    }
+
+private:
+   const std::string _prefix;
+   std::string _name;
+   std::string _leaf;
 };
 
-class GenInfoBranches {
+//---------------------------------  Filtering  -------------------------------------
+
+// Keep/drop glob patterns for the branches booked by RegisterTree. A pattern is
+// matched against both the field name ("L1") and the branch name ("EvtInfo.L1").
+// A field is booked if the keep list is empty or matches it, and the drop list
+// does not match it.
+class BranchFilter {
 public:
-   Int_t Size;
-   Float_t Weight;
-   Float_t Pt [MAX_GENS];
-   Float_t Eta [MAX_GENS];
-   Float_t Phi [MAX_GENS];
-   Float_t Mass [MAX_GENS];
-   Int_t PdgID [MAX_GENS];
-   Int_t PhotonFlag [MAX_GENS];
-   Int_t Status [MAX_GENS];
-   Int_t nMo [MAX_GENS];
-   Int_t nDa [MAX_GENS];
-   Int_t Mo1 [MAX_GENS];
-   Int_t Mo2 [MAX_GENS];
-   Int_t Da1 [MAX_GENS];
-   Int_t Da2 [MAX_GENS];
-   Int_t Mo1PdgID [MAX_GENS];
-   Int_t Mo2PdgID [MAX_GENS];
-   Int_t Mo1Status [MAX_GENS];
-   Int_t Mo2Status [MAX_GENS];
-   Int_t Da1PdgID [MAX_GENS];
-   Int_t Da2PdgID [MAX_GENS];
-   Int_t GrandMo1PdgID [MAX_GENS];
-   Int_t GrandMo2PdgID [MAX_GENS];
-   Int_t GrandMo1Status [MAX_GENS];
-   Int_t GrandMo2Status [MAX_GENS];
-   Float_t LHENominalWeight;
-   Float_t LHEOriginalWeight;
-   Int_t LHESize;
-   Int_t LHESystematicId [MAX_LHE];
-   Float_t LHESystematicWeights [MAX_LHE];
-
-   void RegisterTree( TTree* root, const std::string& name = "GenInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".Weight" ).c_str(), &Weight, ( name + "Weight/F" ).c_str() );
-      root->Branch( ( name + ".Pt" ).c_str(), Pt, ( name + ".Pt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta" ).c_str(), Eta, ( name + ".Eta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi" ).c_str(), Phi, ( name + ".Phi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Mass" ).c_str(), Mass, ( name + ".Mass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PdgID" ).c_str(), PdgID, ( name + ".PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".PhotonFlag" ).c_str(), PhotonFlag, ( name + ".PhotonFlag[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Status" ).c_str(), Status, ( name + ".Status[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".nMo" ).c_str(), nMo, ( name + ".nMo[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".nDa" ).c_str(), nDa, ( name + ".nDa[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo1" ).c_str(), Mo1, ( name + ".Mo1[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo2" ).c_str(), Mo2, ( name + ".Mo2[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Da1" ).c_str(), Da1, ( name + ".Da1[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Da2" ).c_str(), Da2, ( name + ".Da2[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo1PdgID" ).c_str(), Mo1PdgID, ( name + ".Mo1PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo2PdgID" ).c_str(), Mo2PdgID, ( name + ".Mo2PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo1Status" ).c_str(), Mo1Status, ( name + ".Mo1Status[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Mo2Status" ).c_str(), Mo2Status, ( name + ".Mo2Status[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Da1PdgID" ).c_str(), Da1PdgID, ( name + ".Da1PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Da2PdgID" ).c_str(), Da2PdgID, ( name + ".Da2PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GrandMo1PdgID" ).c_str(), GrandMo1PdgID, ( name + ".GrandMo1PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GrandMo2PdgID" ).c_str(), GrandMo2PdgID, ( name + ".GrandMo2PdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GrandMo1Status" ).c_str(), GrandMo1Status, ( name + ".GrandMo1Status[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GrandMo2Status" ).c_str(), GrandMo2Status, ( name + ".GrandMo2Status[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".LHENominalWeight" ).c_str(), &LHENominalWeight, ( name + "LHENominalWeight/F" ).c_str() );
-      root->Branch( ( name + ".LHEOriginalWeight" ).c_str(), &LHEOriginalWeight, ( name + "LHEOriginalWeight/F" ).c_str() );
-      root->Branch( ( name + ".LHESize" ).c_str(), &LHESize, ( name + "LHESize/I" ).c_str() );
-      root->Branch( ( name + ".LHESystematicId" ).c_str(), LHESystematicId, ( name + ".LHESystematicId[" + name + ".LHESize]/I" ).c_str() );
-      root->Branch( ( name + ".LHESystematicWeights" ).c_str(), LHESystematicWeights, ( name + ".LHESystematicWeights[" + name + ".LHESize]/F" ).c_str() );
+   BranchFilter() {}
+   BranchFilter( const std::vector<std::string>& keep, const std::vector<std::string>& drop ) :
+      _keep( keep ), _drop( drop ) {}
+
+   bool Pass( const char* field, const char* branch ) const {
+      return ( _keep.empty() || Match( _keep, field, branch ) ) && !Match( _drop, field, branch );
    }
 
-   void Register( TTree* root, const std::string& name = "GenInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".Weight" ).c_str() , &Weight );
-      root->SetBranchAddress( ( name + ".Pt" ).c_str() , Pt );
-      root->SetBranchAddress( ( name + ".Eta" ).c_str() , Eta );
-      root->SetBranchAddress( ( name + ".Phi" ).c_str() , Phi );
-      root->SetBranchAddress( ( name + ".Mass" ).c_str() , Mass );
-      root->SetBranchAddress( ( name + ".PdgID" ).c_str() , PdgID );
-      root->SetBranchAddress( ( name + ".PhotonFlag" ).c_str() , PhotonFlag );
-      root->SetBranchAddress( ( name + ".Status" ).c_str() , Status );
-      root->SetBranchAddress( ( name + ".nMo" ).c_str() , nMo );
-      root->SetBranchAddress( ( name + ".nDa" ).c_str() , nDa );
-      root->SetBranchAddress( ( name + ".Mo1" ).c_str() , Mo1 );
-      root->SetBranchAddress( ( name + ".Mo2" ).c_str() , Mo2 );
-      root->SetBranchAddress( ( name + ".Da1" ).c_str() , Da1 );
-      root->SetBranchAddress( ( name + ".Da2" ).c_str() , Da2 );
-      root->SetBranchAddress( ( name + ".Mo1PdgID" ).c_str() , Mo1PdgID );
-      root->SetBranchAddress( ( name + ".Mo2PdgID" ).c_str() , Mo2PdgID );
-      root->SetBranchAddress( ( name + ".Mo1Status" ).c_str() , Mo1Status );
-      root->SetBranchAddress( ( name + ".Mo2Status" ).c_str() , Mo2Status );
-      root->SetBranchAddress( ( name + ".Da1PdgID" ).c_str() , Da1PdgID );
-      root->SetBranchAddress( ( name + ".Da2PdgID" ).c_str() , Da2PdgID );
-      root->SetBranchAddress( ( name + ".GrandMo1PdgID" ).c_str() , GrandMo1PdgID );
-      root->SetBranchAddress( ( name + ".GrandMo2PdgID" ).c_str() , GrandMo2PdgID );
-      root->SetBranchAddress( ( name + ".GrandMo1Status" ).c_str() , GrandMo1Status );
-      root->SetBranchAddress( ( name + ".GrandMo2Status" ).c_str() , GrandMo2Status );
-      root->SetBranchAddress( ( name + ".LHENominalWeight" ).c_str() , &LHENominalWeight );
-      root->SetBranchAddress( ( name + ".LHEOriginalWeight" ).c_str() , &LHEOriginalWeight );
-      root->SetBranchAddress( ( name + ".LHESize" ).c_str() , &LHESize );
-      root->SetBranchAddress( ( name + ".LHESystematicId" ).c_str() , LHESystematicId );
-      root->SetBranchAddress( ( name + ".LHESystematicWeights" ).c_str() , LHESystematicWeights );
+   // Copy of the filter additionally dropping the given patterns
+   BranchFilter Drop( const std::vector<std::string>& drop ) const {
+      BranchFilter ans( *this );
+      ans._drop.insert( ans._drop.end(), drop.begin(), drop.end() );
+      return ans;
+   }
+
+private:
+   std::vector<std::string> _keep;
+   std::vector<std::string> _drop;
+
+   static bool Match( const std::vector<std::string>& patternlist, const char* field, const char* branch ) {
+      for( const auto& pattern : patternlist ){
+         if( fnmatch( pattern.c_str(), field, 0 ) == 0 || fnmatch( pattern.c_str(), branch, 0 ) == 0 ){
+            return true;
+         }
+      }
+      return false;
    }
 };
 
-class JetInfoBranches {
+//--------------------------------  Visitors  ---------------------------------------
+
+// Listing the count fields used by the variable length arrays passing the filter,
+// these are booked regardless of the filter.
+class CountCollector {
 public:
-   Int_t Size;
-   Int_t Index [MAX_JETS];
-   Int_t NTracks [MAX_JETS];
-   Float_t Et [MAX_JETS];
-   Float_t Pt [MAX_JETS];
-   Float_t Eta [MAX_JETS];
-   Float_t Phi [MAX_JETS];
-   Float_t Px [MAX_JETS];
-   Float_t Py [MAX_JETS];
-   Float_t Pz [MAX_JETS];
-   Float_t Energy [MAX_JETS];
-   Float_t Mass [MAX_JETS];
-   Float_t Area [MAX_JETS];
-   Int_t JetIDLOOSE [MAX_JETS];
-   Float_t JetCharge [MAX_JETS];
-   Int_t NConstituents [MAX_JETS];
-   Float_t Pt_MuonCleaned [MAX_JETS];
-   Float_t Eta_MuonCleaned [MAX_JETS];
-   Float_t Phi_MuonCleaned [MAX_JETS];
-   Float_t Energy_MuonCleaned [MAX_JETS];
-   Float_t Unc [MAX_JETS];
-   Float_t JesUnc [MAX_JETS];
-   Float_t JERPt [MAX_JETS];
-   Float_t JERPhi [MAX_JETS];
-   Float_t JERScale [MAX_JETS];
-   Float_t PtUncleaned [MAX_JETS];
-   Float_t EtaUncleaned [MAX_JETS];
-   Float_t PhiUncleaned [MAX_JETS];
-   Float_t EnergyUncleaned [MAX_JETS];
-   Float_t QGTagsLikelihood [MAX_JETS];
-   Float_t QGTagsAxis2 [MAX_JETS];
-   Float_t QGTagsMult [MAX_JETS];
-   Float_t QGTagsPtD [MAX_JETS];
-   Int_t NCH [MAX_JETS];
-   Float_t CEF [MAX_JETS];
-   Float_t NHF [MAX_JETS];
-   Float_t NEF [MAX_JETS];
-   Float_t CHF [MAX_JETS];
-   Float_t PtCorrRaw [MAX_JETS];
-   Float_t PtCorrL2 [MAX_JETS];
-   Float_t PtCorrL3 [MAX_JETS];
-   Float_t PtCorrL7g [MAX_JETS];
-   Float_t PtCorrL7uds [MAX_JETS];
-   Float_t PtCorrL7c [MAX_JETS];
-   Float_t PtCorrL7b [MAX_JETS];
-   Float_t combinedSecondaryVertexBJetTags [MAX_JETS];
-   Float_t pfJetBProbabilityBJetTags [MAX_JETS];
-   Float_t pfJetProbabilityBJetTags [MAX_JETS];
-   Float_t pfTrackCountingHighPurBJetTags [MAX_JETS];
-   Float_t pfTrackCountingHighEffBJetTags [MAX_JETS];
-   Float_t pfSimpleSecondaryVertexHighEffBJetTags [MAX_JETS];
-   Float_t pfSimpleSecondaryVertexHighPurBJetTags [MAX_JETS];
-   Float_t pfCombinedSecondaryVertexV2BJetTags [MAX_JETS];
-   Float_t pfCombinedInclusiveSecondaryVertexV2BJetTags [MAX_JETS];
-   Float_t pfCombinedSecondaryVertexSoftLeptonBJetTags [MAX_JETS];
-   Float_t pfCombinedMVABJetTags [MAX_JETS];
-   Float_t pfBoostedDoubleSecondaryVertexAK8BJetTags [MAX_JETS];
-   Float_t GenJetPt [MAX_JETS];
-   Float_t GenJetEta [MAX_JETS];
-   Float_t GenJetPhi [MAX_JETS];
-   Float_t GenPt [MAX_JETS];
-   Float_t GenEta [MAX_JETS];
-   Float_t GenPhi [MAX_JETS];
-   Int_t GenPdgID [MAX_JETS];
-   Int_t GenFlavor [MAX_JETS];
-   Int_t GenHadronFlavor [MAX_JETS];
-   Int_t GenMCTag [MAX_JETS];
-   Int_t NSubjets [MAX_JETS];
-   Int_t SubjetsIdxStart [MAX_JETS];
-   Float_t NjettinessAK8tau1 [MAX_JETS];
-   Float_t NjettinessAK8tau2 [MAX_JETS];
-   Float_t NjettinessAK8tau3 [MAX_JETS];
-   Float_t ak8PFJetsCHSSoftDropMass [MAX_JETS];
-   Float_t ak8PFJetsCHSPrunedMass [MAX_JETS];
-   Float_t ak8PFJetsCHSTrimmedMass [MAX_JETS];
-   Float_t ak8PFJetsCHSFilteredMass [MAX_JETS];
-   Float_t topJetMass [MAX_JETS];
-   Float_t ca8TopMass [MAX_JETS];
-   Float_t ca8MinMass [MAX_JETS];
-   Float_t Puppivtx3DSig [MAX_JETS];
-   Float_t Puppivtx3DVal [MAX_JETS];
-   Float_t PuppivtxMass [MAX_JETS];
-   Float_t PuppivtxNtracks [MAX_JETS];
-   Float_t PuppivtxPosX [MAX_JETS];
-   Float_t PuppivtxPosY [MAX_JETS];
-   Float_t PuppivtxPosZ [MAX_JETS];
-   Float_t PuppivtxPx [MAX_JETS];
-   Float_t PuppivtxPy [MAX_JETS];
-   Float_t PuppivtxPz [MAX_JETS];
-   std::vector<Float_t>* SubjetMass;
-   std::vector<Float_t>* SubjetPt;
-   std::vector<Float_t>* SubjetEt;
-   std::vector<Float_t>* SubjetEta;
-   std::vector<Float_t>* SubjetPhi;
-   std::vector<Float_t>* SubjetArea;
-   std::vector<Float_t>* SubjetPtUncorr;
-   std::vector<Float_t>* SubjetCombinedSVBJetTags;
-   std::vector<Float_t>* SubjetGenPdgId;
-   std::vector<Float_t>* SubjetGenFlavour;
-   std::vector<Float_t>* SubjetHadronFlavour;
-   std::vector<Float_t> SubjetMass_w;
-   std::vector<Float_t> SubjetPt_w;
-   std::vector<Float_t> SubjetEt_w;
-   std::vector<Float_t> SubjetEta_w;
-   std::vector<Float_t> SubjetPhi_w;
-   std::vector<Float_t> SubjetArea_w;
-   std::vector<Float_t> SubjetPtUncorr_w;
-   std::vector<Float_t> SubjetCombinedSVBJetTags_w;
-   std::vector<Float_t> SubjetGenPdgId_w;
-   std::vector<Float_t> SubjetGenFlavour_w;
-   std::vector<Float_t> SubjetHadronFlavour_w;
-   Float_t JVAlpha [MAX_JETS];
-   Float_t JVBeta [MAX_JETS];
-
-   void RegisterTree( TTree* root, const std::string& name = "JetInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".Index" ).c_str(), Index, ( name + ".Index[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".NTracks" ).c_str(), NTracks, ( name + ".NTracks[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Et" ).c_str(), Et, ( name + ".Et[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Pt" ).c_str(), Pt, ( name + ".Pt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta" ).c_str(), Eta, ( name + ".Eta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi" ).c_str(), Phi, ( name + ".Phi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Px" ).c_str(), Px, ( name + ".Px[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Py" ).c_str(), Py, ( name + ".Py[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Pz" ).c_str(), Pz, ( name + ".Pz[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Energy" ).c_str(), Energy, ( name + ".Energy[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Mass" ).c_str(), Mass, ( name + ".Mass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Area" ).c_str(), Area, ( name + ".Area[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JetIDLOOSE" ).c_str(), JetIDLOOSE, ( name + ".JetIDLOOSE[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".JetCharge" ).c_str(), JetCharge, ( name + ".JetCharge[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NConstituents" ).c_str(), NConstituents, ( name + ".NConstituents[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Pt_MuonCleaned" ).c_str(), Pt_MuonCleaned, ( name + ".Pt_MuonCleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta_MuonCleaned" ).c_str(), Eta_MuonCleaned, ( name + ".Eta_MuonCleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi_MuonCleaned" ).c_str(), Phi_MuonCleaned, ( name + ".Phi_MuonCleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Energy_MuonCleaned" ).c_str(), Energy_MuonCleaned, ( name + ".Energy_MuonCleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Unc" ).c_str(), Unc, ( name + ".Unc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JesUnc" ).c_str(), JesUnc, ( name + ".JesUnc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JERPt" ).c_str(), JERPt, ( name + ".JERPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JERPhi" ).c_str(), JERPhi, ( name + ".JERPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JERScale" ).c_str(), JERScale, ( name + ".JERScale[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtUncleaned" ).c_str(), PtUncleaned, ( name + ".PtUncleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EtaUncleaned" ).c_str(), EtaUncleaned, ( name + ".EtaUncleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PhiUncleaned" ).c_str(), PhiUncleaned, ( name + ".PhiUncleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EnergyUncleaned" ).c_str(), EnergyUncleaned, ( name + ".EnergyUncleaned[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".QGTagsLikelihood" ).c_str(), QGTagsLikelihood, ( name + ".QGTagsLikelihood[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".QGTagsAxis2" ).c_str(), QGTagsAxis2, ( name + ".QGTagsAxis2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".QGTagsMult" ).c_str(), QGTagsMult, ( name + ".QGTagsMult[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".QGTagsPtD" ).c_str(), QGTagsPtD, ( name + ".QGTagsPtD[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NCH" ).c_str(), NCH, ( name + ".NCH[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".CEF" ).c_str(), CEF, ( name + ".CEF[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NHF" ).c_str(), NHF, ( name + ".NHF[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NEF" ).c_str(), NEF, ( name + ".NEF[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".CHF" ).c_str(), CHF, ( name + ".CHF[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrRaw" ).c_str(), PtCorrRaw, ( name + ".PtCorrRaw[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL2" ).c_str(), PtCorrL2, ( name + ".PtCorrL2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL3" ).c_str(), PtCorrL3, ( name + ".PtCorrL3[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL7g" ).c_str(), PtCorrL7g, ( name + ".PtCorrL7g[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL7uds" ).c_str(), PtCorrL7uds, ( name + ".PtCorrL7uds[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL7c" ).c_str(), PtCorrL7c, ( name + ".PtCorrL7c[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PtCorrL7b" ).c_str(), PtCorrL7b, ( name + ".PtCorrL7b[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".combinedSecondaryVertexBJetTags" ).c_str(), combinedSecondaryVertexBJetTags, ( name + ".combinedSecondaryVertexBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfJetBProbabilityBJetTags" ).c_str(), pfJetBProbabilityBJetTags, ( name + ".pfJetBProbabilityBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfJetProbabilityBJetTags" ).c_str(), pfJetProbabilityBJetTags, ( name + ".pfJetProbabilityBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfTrackCountingHighPurBJetTags" ).c_str(), pfTrackCountingHighPurBJetTags, ( name + ".pfTrackCountingHighPurBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfTrackCountingHighEffBJetTags" ).c_str(), pfTrackCountingHighEffBJetTags, ( name + ".pfTrackCountingHighEffBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfSimpleSecondaryVertexHighEffBJetTags" ).c_str(), pfSimpleSecondaryVertexHighEffBJetTags, ( name + ".pfSimpleSecondaryVertexHighEffBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfSimpleSecondaryVertexHighPurBJetTags" ).c_str(), pfSimpleSecondaryVertexHighPurBJetTags, ( name + ".pfSimpleSecondaryVertexHighPurBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfCombinedSecondaryVertexV2BJetTags" ).c_str(), pfCombinedSecondaryVertexV2BJetTags, ( name + ".pfCombinedSecondaryVertexV2BJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfCombinedInclusiveSecondaryVertexV2BJetTags" ).c_str(), pfCombinedInclusiveSecondaryVertexV2BJetTags, ( name + ".pfCombinedInclusiveSecondaryVertexV2BJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfCombinedSecondaryVertexSoftLeptonBJetTags" ).c_str(), pfCombinedSecondaryVertexSoftLeptonBJetTags, ( name + ".pfCombinedSecondaryVertexSoftLeptonBJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfCombinedMVABJetTags" ).c_str(), pfCombinedMVABJetTags, ( name + ".pfCombinedMVABJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".pfBoostedDoubleSecondaryVertexAK8BJetTags" ).c_str(), pfBoostedDoubleSecondaryVertexAK8BJetTags, ( name + ".pfBoostedDoubleSecondaryVertexAK8BJetTags[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenJetPt" ).c_str(), GenJetPt, ( name + ".GenJetPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenJetEta" ).c_str(), GenJetEta, ( name + ".GenJetEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenJetPhi" ).c_str(), GenJetPhi, ( name + ".GenJetPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPt" ).c_str(), GenPt, ( name + ".GenPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenEta" ).c_str(), GenEta, ( name + ".GenEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPhi" ).c_str(), GenPhi, ( name + ".GenPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPdgID" ).c_str(), GenPdgID, ( name + ".GenPdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GenFlavor" ).c_str(), GenFlavor, ( name + ".GenFlavor[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GenHadronFlavor" ).c_str(), GenHadronFlavor, ( name + ".GenHadronFlavor[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GenMCTag" ).c_str(), GenMCTag, ( name + ".GenMCTag[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".NSubjets" ).c_str(), NSubjets, ( name + ".NSubjets[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".SubjetsIdxStart" ).c_str(), SubjetsIdxStart, ( name + ".SubjetsIdxStart[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".NjettinessAK8tau1" ).c_str(), NjettinessAK8tau1, ( name + ".NjettinessAK8tau1[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NjettinessAK8tau2" ).c_str(), NjettinessAK8tau2, ( name + ".NjettinessAK8tau2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NjettinessAK8tau3" ).c_str(), NjettinessAK8tau3, ( name + ".NjettinessAK8tau3[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ak8PFJetsCHSSoftDropMass" ).c_str(), ak8PFJetsCHSSoftDropMass, ( name + ".ak8PFJetsCHSSoftDropMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ak8PFJetsCHSPrunedMass" ).c_str(), ak8PFJetsCHSPrunedMass, ( name + ".ak8PFJetsCHSPrunedMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ak8PFJetsCHSTrimmedMass" ).c_str(), ak8PFJetsCHSTrimmedMass, ( name + ".ak8PFJetsCHSTrimmedMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ak8PFJetsCHSFilteredMass" ).c_str(), ak8PFJetsCHSFilteredMass, ( name + ".ak8PFJetsCHSFilteredMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".topJetMass" ).c_str(), topJetMass, ( name + ".topJetMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ca8TopMass" ).c_str(), ca8TopMass, ( name + ".ca8TopMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ca8MinMass" ).c_str(), ca8MinMass, ( name + ".ca8MinMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Puppivtx3DSig" ).c_str(), Puppivtx3DSig, ( name + ".Puppivtx3DSig[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Puppivtx3DVal" ).c_str(), Puppivtx3DVal, ( name + ".Puppivtx3DVal[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxMass" ).c_str(), PuppivtxMass, ( name + ".PuppivtxMass[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxNtracks" ).c_str(), PuppivtxNtracks, ( name + ".PuppivtxNtracks[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPosX" ).c_str(), PuppivtxPosX, ( name + ".PuppivtxPosX[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPosY" ).c_str(), PuppivtxPosY, ( name + ".PuppivtxPosY[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPosZ" ).c_str(), PuppivtxPosZ, ( name + ".PuppivtxPosZ[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPx" ).c_str(), PuppivtxPx, ( name + ".PuppivtxPx[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPy" ).c_str(), PuppivtxPy, ( name + ".PuppivtxPy[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PuppivtxPz" ).c_str(), PuppivtxPz, ( name + ".PuppivtxPz[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".SubjetMass" ).c_str(), &SubjetMass_w );
-      root->Branch( ( name + ".SubjetPt" ).c_str(), &SubjetPt_w );
-      root->Branch( ( name + ".SubjetEt" ).c_str(), &SubjetEt_w );
-      root->Branch( ( name + ".SubjetEta" ).c_str(), &SubjetEta_w );
-      root->Branch( ( name + ".SubjetPhi" ).c_str(), &SubjetPhi_w );
-      root->Branch( ( name + ".SubjetArea" ).c_str(), &SubjetArea_w );
-      root->Branch( ( name + ".SubjetPtUncorr" ).c_str(), &SubjetPtUncorr_w );
-      root->Branch( ( name + ".SubjetCombinedSVBJetTags" ).c_str(), &SubjetCombinedSVBJetTags_w );
-      root->Branch( ( name + ".SubjetGenPdgId" ).c_str(), &SubjetGenPdgId_w );
-      root->Branch( ( name + ".SubjetGenFlavour" ).c_str(), &SubjetGenFlavour_w );
-      root->Branch( ( name + ".SubjetHadronFlavour" ).c_str(), &SubjetHadronFlavour_w );
-      root->Branch( ( name + ".JVAlpha" ).c_str(), JVAlpha, ( name + ".JVAlpha[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".JVBeta" ).c_str(), JVBeta, ( name + ".JVBeta[" + name + ".Size]/F" ).c_str() );
-   }
+   CountCollector( const std::string& prefix, const BranchFilter& filter ) : _namer( prefix ), _filter( filter ) {}
+
+   template<typename T>
+   void Scalar( const char*, T&, const char* ) {}
 
-   void Register( TTree* root, const std::string& name = "JetInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".Index" ).c_str() , Index );
-      root->SetBranchAddress( ( name + ".NTracks" ).c_str() , NTracks );
-      root->SetBranchAddress( ( name + ".Et" ).c_str() , Et );
-      root->SetBranchAddress( ( name + ".Pt" ).c_str() , Pt );
-      root->SetBranchAddress( ( name + ".Eta" ).c_str() , Eta );
-      root->SetBranchAddress( ( name + ".Phi" ).c_str() , Phi );
-      root->SetBranchAddress( ( name + ".Px" ).c_str() , Px );
-      root->SetBranchAddress( ( name + ".Py" ).c_str() , Py );
-      root->SetBranchAddress( ( name + ".Pz" ).c_str() , Pz );
-      root->SetBranchAddress( ( name + ".Energy" ).c_str() , Energy );
-      root->SetBranchAddress( ( name + ".Mass" ).c_str() , Mass );
-      root->SetBranchAddress( ( name + ".Area" ).c_str() , Area );
-      root->SetBranchAddress( ( name + ".JetIDLOOSE" ).c_str() , JetIDLOOSE );
-      root->SetBranchAddress( ( name + ".JetCharge" ).c_str() , JetCharge );
-      root->SetBranchAddress( ( name + ".NConstituents" ).c_str() , NConstituents );
-      root->SetBranchAddress( ( name + ".Pt_MuonCleaned" ).c_str() , Pt_MuonCleaned );
-      root->SetBranchAddress( ( name + ".Eta_MuonCleaned" ).c_str() , Eta_MuonCleaned );
-      root->SetBranchAddress( ( name + ".Phi_MuonCleaned" ).c_str() , Phi_MuonCleaned );
-      root->SetBranchAddress( ( name + ".Energy_MuonCleaned" ).c_str() , Energy_MuonCleaned );
-      root->SetBranchAddress( ( name + ".Unc" ).c_str() , Unc );
-      root->SetBranchAddress( ( name + ".JesUnc" ).c_str() , JesUnc );
-      root->SetBranchAddress( ( name + ".JERPt" ).c_str() , JERPt );
-      root->SetBranchAddress( ( name + ".JERPhi" ).c_str() , JERPhi );
-      root->SetBranchAddress( ( name + ".JERScale" ).c_str() , JERScale );
-      root->SetBranchAddress( ( name + ".PtUncleaned" ).c_str() , PtUncleaned );
-      root->SetBranchAddress( ( name + ".EtaUncleaned" ).c_str() , EtaUncleaned );
-      root->SetBranchAddress( ( name + ".PhiUncleaned" ).c_str() , PhiUncleaned );
-      root->SetBranchAddress( ( name + ".EnergyUncleaned" ).c_str() , EnergyUncleaned );
-      root->SetBranchAddress( ( name + ".QGTagsLikelihood" ).c_str() , QGTagsLikelihood );
-      root->SetBranchAddress( ( name + ".QGTagsAxis2" ).c_str() , QGTagsAxis2 );
-      root->SetBranchAddress( ( name + ".QGTagsMult" ).c_str() , QGTagsMult );
-      root->SetBranchAddress( ( name + ".QGTagsPtD" ).c_str() , QGTagsPtD );
-      root->SetBranchAddress( ( name + ".NCH" ).c_str() , NCH );
-      root->SetBranchAddress( ( name + ".CEF" ).c_str() , CEF );
-      root->SetBranchAddress( ( name + ".NHF" ).c_str() , NHF );
-      root->SetBranchAddress( ( name + ".NEF" ).c_str() , NEF );
-      root->SetBranchAddress( ( name + ".CHF" ).c_str() , CHF );
-      root->SetBranchAddress( ( name + ".PtCorrRaw" ).c_str() , PtCorrRaw );
-      root->SetBranchAddress( ( name + ".PtCorrL2" ).c_str() , PtCorrL2 );
-      root->SetBranchAddress( ( name + ".PtCorrL3" ).c_str() , PtCorrL3 );
-      root->SetBranchAddress( ( name + ".PtCorrL7g" ).c_str() , PtCorrL7g );
-      root->SetBranchAddress( ( name + ".PtCorrL7uds" ).c_str() , PtCorrL7uds );
-      root->SetBranchAddress( ( name + ".PtCorrL7c" ).c_str() , PtCorrL7c );
-      root->SetBranchAddress( ( name + ".PtCorrL7b" ).c_str() , PtCorrL7b );
-      root->SetBranchAddress( ( name + ".combinedSecondaryVertexBJetTags" ).c_str() , combinedSecondaryVertexBJetTags );
-      root->SetBranchAddress( ( name + ".pfJetBProbabilityBJetTags" ).c_str() , pfJetBProbabilityBJetTags );
-      root->SetBranchAddress( ( name + ".pfJetProbabilityBJetTags" ).c_str() , pfJetProbabilityBJetTags );
-      root->SetBranchAddress( ( name + ".pfTrackCountingHighPurBJetTags" ).c_str() , pfTrackCountingHighPurBJetTags );
-      root->SetBranchAddress( ( name + ".pfTrackCountingHighEffBJetTags" ).c_str() , pfTrackCountingHighEffBJetTags );
-      root->SetBranchAddress( ( name + ".pfSimpleSecondaryVertexHighEffBJetTags" ).c_str() , pfSimpleSecondaryVertexHighEffBJetTags );
-      root->SetBranchAddress( ( name + ".pfSimpleSecondaryVertexHighPurBJetTags" ).c_str() , pfSimpleSecondaryVertexHighPurBJetTags );
-      root->SetBranchAddress( ( name + ".pfCombinedSecondaryVertexV2BJetTags" ).c_str() , pfCombinedSecondaryVertexV2BJetTags );
-      root->SetBranchAddress( ( name + ".pfCombinedInclusiveSecondaryVertexV2BJetTags" ).c_str() , pfCombinedInclusiveSecondaryVertexV2BJetTags );
-      root->SetBranchAddress( ( name + ".pfCombinedSecondaryVertexSoftLeptonBJetTags" ).c_str() , pfCombinedSecondaryVertexSoftLeptonBJetTags );
-      root->SetBranchAddress( ( name + ".pfCombinedMVABJetTags" ).c_str() , pfCombinedMVABJetTags );
-      root->SetBranchAddress( ( name + ".pfBoostedDoubleSecondaryVertexAK8BJetTags" ).c_str() , pfBoostedDoubleSecondaryVertexAK8BJetTags );
-      root->SetBranchAddress( ( name + ".GenJetPt" ).c_str() , GenJetPt );
-      root->SetBranchAddress( ( name + ".GenJetEta" ).c_str() , GenJetEta );
-      root->SetBranchAddress( ( name + ".GenJetPhi" ).c_str() , GenJetPhi );
-      root->SetBranchAddress( ( name + ".GenPt" ).c_str() , GenPt );
-      root->SetBranchAddress( ( name + ".GenEta" ).c_str() , GenEta );
-      root->SetBranchAddress( ( name + ".GenPhi" ).c_str() , GenPhi );
-      root->SetBranchAddress( ( name + ".GenPdgID" ).c_str() , GenPdgID );
-      root->SetBranchAddress( ( name + ".GenFlavor" ).c_str() , GenFlavor );
-      root->SetBranchAddress( ( name + ".GenHadronFlavor" ).c_str() , GenHadronFlavor );
-      root->SetBranchAddress( ( name + ".GenMCTag" ).c_str() , GenMCTag );
-      root->SetBranchAddress( ( name + ".NSubjets" ).c_str() , NSubjets );
-      root->SetBranchAddress( ( name + ".SubjetsIdxStart" ).c_str() , SubjetsIdxStart );
-      root->SetBranchAddress( ( name + ".NjettinessAK8tau1" ).c_str() , NjettinessAK8tau1 );
-      root->SetBranchAddress( ( name + ".NjettinessAK8tau2" ).c_str() , NjettinessAK8tau2 );
-      root->SetBranchAddress( ( name + ".NjettinessAK8tau3" ).c_str() , NjettinessAK8tau3 );
-      root->SetBranchAddress( ( name + ".ak8PFJetsCHSSoftDropMass" ).c_str() , ak8PFJetsCHSSoftDropMass );
-      root->SetBranchAddress( ( name + ".ak8PFJetsCHSPrunedMass" ).c_str() , ak8PFJetsCHSPrunedMass );
-      root->SetBranchAddress( ( name + ".ak8PFJetsCHSTrimmedMass" ).c_str() , ak8PFJetsCHSTrimmedMass );
-      root->SetBranchAddress( ( name + ".ak8PFJetsCHSFilteredMass" ).c_str() , ak8PFJetsCHSFilteredMass );
-      root->SetBranchAddress( ( name + ".topJetMass" ).c_str() , topJetMass );
-      root->SetBranchAddress( ( name + ".ca8TopMass" ).c_str() , ca8TopMass );
-      root->SetBranchAddress( ( name + ".ca8MinMass" ).c_str() , ca8MinMass );
-      root->SetBranchAddress( ( name + ".Puppivtx3DSig" ).c_str() , Puppivtx3DSig );
-      root->SetBranchAddress( ( name + ".Puppivtx3DVal" ).c_str() , Puppivtx3DVal );
-      root->SetBranchAddress( ( name + ".PuppivtxMass" ).c_str() , PuppivtxMass );
-      root->SetBranchAddress( ( name + ".PuppivtxNtracks" ).c_str() , PuppivtxNtracks );
-      root->SetBranchAddress( ( name + ".PuppivtxPosX" ).c_str() , PuppivtxPosX );
-      root->SetBranchAddress( ( name + ".PuppivtxPosY" ).c_str() , PuppivtxPosY );
-      root->SetBranchAddress( ( name + ".PuppivtxPosZ" ).c_str() , PuppivtxPosZ );
-      root->SetBranchAddress( ( name + ".PuppivtxPx" ).c_str() , PuppivtxPx );
-      root->SetBranchAddress( ( name + ".PuppivtxPy" ).c_str() , PuppivtxPy );
-      root->SetBranchAddress( ( name + ".PuppivtxPz" ).c_str() , PuppivtxPz );
-      SubjetMass = 0;
-      root->SetBranchAddress( ( name + ".SubjetMass" ).c_str() , &SubjetMass );
-      SubjetPt = 0;
-      root->SetBranchAddress( ( name + ".SubjetPt" ).c_str() , &SubjetPt );
-      SubjetEt = 0;
-      root->SetBranchAddress( ( name + ".SubjetEt" ).c_str() , &SubjetEt );
-      SubjetEta = 0;
-      root->SetBranchAddress( ( name + ".SubjetEta" ).c_str() , &SubjetEta );
-      SubjetPhi = 0;
-      root->SetBranchAddress( ( name + ".SubjetPhi" ).c_str() , &SubjetPhi );
-      SubjetArea = 0;
-      root->SetBranchAddress( ( name + ".SubjetArea" ).c_str() , &SubjetArea );
-      SubjetPtUncorr = 0;
-      root->SetBranchAddress( ( name + ".SubjetPtUncorr" ).c_str() , &SubjetPtUncorr );
-      SubjetCombinedSVBJetTags = 0;
-      root->SetBranchAddress( ( name + ".SubjetCombinedSVBJetTags" ).c_str() , &SubjetCombinedSVBJetTags );
-      SubjetGenPdgId = 0;
-      root->SetBranchAddress( ( name + ".SubjetGenPdgId" ).c_str() , &SubjetGenPdgId );
-      SubjetGenFlavour = 0;
-      root->SetBranchAddress( ( name + ".SubjetGenFlavour" ).c_str() , &SubjetGenFlavour );
-      SubjetHadronFlavour = 0;
-      root->SetBranchAddress( ( name + ".SubjetHadronFlavour" ).c_str() , &SubjetHadronFlavour );
-      root->SetBranchAddress( ( name + ".JVAlpha" ).c_str() , JVAlpha );
-      root->SetBranchAddress( ( name + ".JVBeta" ).c_str() , JVBeta );
+   template<typename T, size_t N>
+   void Array( const char*, T (&)[N], const char* ) {}
+
+   template<typename T, size_t N>
+   void VarArray( const char* field, T (&)[N], const char* countfield, Int_t&, const char* ) {
+      if( _filter.Pass( field, _namer.Name( field ) ) ){ _countlist.push_back( countfield ); }
    }
+
+   template<typename T>
+   void Vector( const char*, std::vector<T>&, std::vector<T>*& ) {}
+
+   template<size_t N>
+   void String( const char*, Char_t (&)[N] ) {}
+
+   const std::vector<std::string>& CountList() const { return _countlist; }
+
+private:
+   BranchNamer _namer;
+   const BranchFilter& _filter;
+   std::vector<std::string> _countlist;
 };
 
-class LepInfoBranches {
+// Creating the branches for writing, fields not passing the filter are skipped
+class BranchBooker {
 public:
-   Int_t Size;
-   Int_t Index [MAX_LEPTONS];
-   Int_t LeptonType [MAX_LEPTONS];
-   Int_t Charge [MAX_LEPTONS];
-   Float_t Pt [MAX_LEPTONS];
-   Float_t Et [MAX_LEPTONS];
-   Float_t Eta [MAX_LEPTONS];
-   Float_t Phi [MAX_LEPTONS];
-   Float_t Px [MAX_LEPTONS];
-   Float_t Py [MAX_LEPTONS];
-   Float_t Pz [MAX_LEPTONS];
-   Float_t Energy [MAX_LEPTONS];
-   Float_t TrackIso [MAX_LEPTONS];
-   Float_t EcalIso [MAX_LEPTONS];
-   Float_t HcalIso [MAX_LEPTONS];
-   Float_t ChargedHadronIso [MAX_LEPTONS];
-   Float_t NeutralHadronIso [MAX_LEPTONS];
-   Float_t PhotonIso [MAX_LEPTONS];
-   Float_t SumPUPt [MAX_LEPTONS];
-   Float_t ChargedHadronIsoR03 [MAX_LEPTONS];
-   Float_t NeutralHadronIsoR03 [MAX_LEPTONS];
-   Float_t PhotonIsoR03 [MAX_LEPTONS];
-   Float_t sumPUPtR03 [MAX_LEPTONS];
-   Float_t IsoRhoCorrR03 [MAX_LEPTONS];
-   Float_t ChargedHadronIsoR04 [MAX_LEPTONS];
-   Float_t NeutralHadronIsoR04 [MAX_LEPTONS];
-   Float_t PhotonIsoR04 [MAX_LEPTONS];
-   Float_t sumPUPtR04 [MAX_LEPTONS];
-   Float_t IsoRhoCorrR04 [MAX_LEPTONS];
-   Float_t Ip3dPV [MAX_LEPTONS];
-   Float_t Ip3dPVErr [MAX_LEPTONS];
-   Float_t Ip3dPVSignificance [MAX_LEPTONS];
-   Float_t MiniIso [MAX_LEPTONS];
-   Float_t CaloEnergy [MAX_LEPTONS];
-   Bool_t isGoodMuonTMOneStationTight [MAX_LEPTONS];
-   Bool_t isPFMuon [MAX_LEPTONS];
-   Bool_t MuIDGlobalMuonPromptTight [MAX_LEPTONS];
-   Float_t MuGlobalNormalizedChi2 [MAX_LEPTONS];
-   Float_t MuCaloCompat [MAX_LEPTONS];
-   Int_t MuNChambers [MAX_LEPTONS];
-   Int_t MuNChambersMatchesSegment [MAX_LEPTONS];
-   Int_t MuNMatchedStations [MAX_LEPTONS];
-   Int_t MuNLostOuterHits [MAX_LEPTONS];
-   Int_t MuNMuonhits [MAX_LEPTONS];
-   Int_t MuDThits [MAX_LEPTONS];
-   Int_t MuCSChits [MAX_LEPTONS];
-   Int_t MuRPChits [MAX_LEPTONS];
-   Int_t MuType [MAX_LEPTONS];
-   Int_t MuontimenDof [MAX_LEPTONS];
-   Float_t MuontimeAtIpInOut [MAX_LEPTONS];
-   Float_t MuontimeAtIpOutIn [MAX_LEPTONS];
-   Int_t Muondirection [MAX_LEPTONS];
-   Float_t innerTracknormalizedChi2 [MAX_LEPTONS];
-   Float_t MuInnerPtError [MAX_LEPTONS];
-   Float_t MuGlobalPtError [MAX_LEPTONS];
-   Float_t MuInnerTrackDz [MAX_LEPTONS];
-   Float_t MuInnerTrackD0 [MAX_LEPTONS];
-   Float_t MuInnerTrackDxy_BS [MAX_LEPTONS];
-   Float_t MuInnerTrackDxy_PV [MAX_LEPTONS];
-   Float_t MuInnerTrackDxy_PVBS [MAX_LEPTONS];
-   Int_t MuInnerTrackNHits [MAX_LEPTONS];
-   Int_t MuNTrackerHits [MAX_LEPTONS];
-   Int_t MuNLostInnerHits [MAX_LEPTONS];
-   Float_t vertexZ [MAX_LEPTONS];
-   Int_t MuNPixelLayers [MAX_LEPTONS];
-   Int_t MuNPixelLayersWMeasurement [MAX_LEPTONS];
-   Int_t MuNTrackLayersWMeasurement [MAX_LEPTONS];
-   Int_t ChargeGsf [MAX_LEPTONS];
-   Int_t ChargeCtf [MAX_LEPTONS];
-   Int_t ChargeScPix [MAX_LEPTONS];
-   Int_t isEcalDriven [MAX_LEPTONS];
-   Int_t isTrackerDriven [MAX_LEPTONS];
-   Float_t caloEta [MAX_LEPTONS];
-   Float_t e1x5 [MAX_LEPTONS];
-   Float_t e2x5Max [MAX_LEPTONS];
-   Float_t e5x5 [MAX_LEPTONS];
-   Float_t HcalDepth1Iso [MAX_LEPTONS];
-   Float_t HcalDepth2Iso [MAX_LEPTONS];
-   Float_t EgammaMVANonTrig [MAX_LEPTONS];
-   Float_t EgammaMVATrig [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdTRIGGERTIGHT [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdTRIGGERWP70 [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdVETO [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdLOOSE [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdMEDIUM [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdTIGHT [MAX_LEPTONS];
-   Bool_t EgammaCutBasedEleIdHEEP [MAX_LEPTONS];
-   Float_t Eldr03HcalDepth1TowerSumEtBc [MAX_LEPTONS];
-   Float_t Eldr03HcalDepth2TowerSumEtBc [MAX_LEPTONS];
-   Float_t Eldr04HcalDepth1TowerSumEtBc [MAX_LEPTONS];
-   Float_t Eldr04HcalDepth2TowerSumEtBc [MAX_LEPTONS];
-   Float_t ElhcalOverEcalBc [MAX_LEPTONS];
-   Float_t ElEcalE [MAX_LEPTONS];
-   Float_t ElEoverP [MAX_LEPTONS];
-   Float_t EldeltaEta [MAX_LEPTONS];
-   Float_t EldeltaPhi [MAX_LEPTONS];
-   Float_t ElHadoverEm [MAX_LEPTONS];
-   Float_t ElsigmaIetaIeta [MAX_LEPTONS];
-   Float_t ElscSigmaIetaIeta [MAX_LEPTONS];
-   Float_t ElEnergyErr [MAX_LEPTONS];
-   Float_t ElMomentumErr [MAX_LEPTONS];
-   Float_t ElSharedHitsFraction [MAX_LEPTONS];
-   Float_t dR_gsf_ctfTrack [MAX_LEPTONS];
-   Float_t dPt_gsf_ctfTrack [MAX_LEPTONS];
-   Bool_t ElhasConv [MAX_LEPTONS];
-   Int_t ElTrackNHits [MAX_LEPTONS];
-   Float_t ElTrackNLostHits [MAX_LEPTONS];
-   Float_t ElTrackDz [MAX_LEPTONS];
-   Float_t ElTrackDz_BS [MAX_LEPTONS];
-   Float_t ElTrackD0 [MAX_LEPTONS];
-   Float_t ElTrackDxy_BS [MAX_LEPTONS];
-   Float_t ElTrackDxy_PV [MAX_LEPTONS];
-   Float_t ElTrackDxy_PVBS [MAX_LEPTONS];
-   Int_t ElNClusters [MAX_LEPTONS];
-   Int_t ElClassification [MAX_LEPTONS];
-   Float_t ElFBrem [MAX_LEPTONS];
-   Int_t NumberOfExpectedInnerHits [MAX_LEPTONS];
-   Float_t Eldist [MAX_LEPTONS];
-   Float_t Eldcot [MAX_LEPTONS];
-   Float_t Elconvradius [MAX_LEPTONS];
-   Float_t ElConvPoint_x [MAX_LEPTONS];
-   Float_t ElConvPoint_y [MAX_LEPTONS];
-   Float_t ElConvPoint_z [MAX_LEPTONS];
-   Float_t dcotdist [MAX_LEPTONS];
-   Float_t ElseedEoverP [MAX_LEPTONS];
-   Float_t ElEcalIso04 [MAX_LEPTONS];
-   Float_t ElHcalIso04 [MAX_LEPTONS];
-   Int_t ElNumberOfBrems [MAX_LEPTONS];
-   Float_t TrgPt [MAX_LEPTONS];
-   Float_t TrgEta [MAX_LEPTONS];
-   Float_t TrgPhi [MAX_LEPTONS];
-   Int_t TrgID [MAX_LEPTONS];
-   Int_t isPFTau [MAX_LEPTONS];
-   Float_t GenPt [MAX_LEPTONS];
-   Float_t GenEta [MAX_LEPTONS];
-   Float_t GenPhi [MAX_LEPTONS];
-   Int_t GenPdgID [MAX_LEPTONS];
-   Int_t GenMCTag [MAX_LEPTONS];
-
-   void RegisterTree( TTree* root, const std::string& name = "LepInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".Index" ).c_str(), Index, ( name + ".Index[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".LeptonType" ).c_str(), LeptonType, ( name + ".LeptonType[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Charge" ).c_str(), Charge, ( name + ".Charge[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Pt" ).c_str(), Pt, ( name + ".Pt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Et" ).c_str(), Et, ( name + ".Et[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta" ).c_str(), Eta, ( name + ".Eta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi" ).c_str(), Phi, ( name + ".Phi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Px" ).c_str(), Px, ( name + ".Px[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Py" ).c_str(), Py, ( name + ".Py[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Pz" ).c_str(), Pz, ( name + ".Pz[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Energy" ).c_str(), Energy, ( name + ".Energy[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".TrackIso" ).c_str(), TrackIso, ( name + ".TrackIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EcalIso" ).c_str(), EcalIso, ( name + ".EcalIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".HcalIso" ).c_str(), HcalIso, ( name + ".HcalIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ChargedHadronIso" ).c_str(), ChargedHadronIso, ( name + ".ChargedHadronIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NeutralHadronIso" ).c_str(), NeutralHadronIso, ( name + ".NeutralHadronIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PhotonIso" ).c_str(), PhotonIso, ( name + ".PhotonIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".SumPUPt" ).c_str(), SumPUPt, ( name + ".SumPUPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ChargedHadronIsoR03" ).c_str(), ChargedHadronIsoR03, ( name + ".ChargedHadronIsoR03[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NeutralHadronIsoR03" ).c_str(), NeutralHadronIsoR03, ( name + ".NeutralHadronIsoR03[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PhotonIsoR03" ).c_str(), PhotonIsoR03, ( name + ".PhotonIsoR03[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".sumPUPtR03" ).c_str(), sumPUPtR03, ( name + ".sumPUPtR03[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".IsoRhoCorrR03" ).c_str(), IsoRhoCorrR03, ( name + ".IsoRhoCorrR03[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ChargedHadronIsoR04" ).c_str(), ChargedHadronIsoR04, ( name + ".ChargedHadronIsoR04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NeutralHadronIsoR04" ).c_str(), NeutralHadronIsoR04, ( name + ".NeutralHadronIsoR04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".PhotonIsoR04" ).c_str(), PhotonIsoR04, ( name + ".PhotonIsoR04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".sumPUPtR04" ).c_str(), sumPUPtR04, ( name + ".sumPUPtR04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".IsoRhoCorrR04" ).c_str(), IsoRhoCorrR04, ( name + ".IsoRhoCorrR04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Ip3dPV" ).c_str(), Ip3dPV, ( name + ".Ip3dPV[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Ip3dPVErr" ).c_str(), Ip3dPVErr, ( name + ".Ip3dPVErr[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Ip3dPVSignificance" ).c_str(), Ip3dPVSignificance, ( name + ".Ip3dPVSignificance[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MiniIso" ).c_str(), MiniIso, ( name + ".MiniIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".CaloEnergy" ).c_str(), CaloEnergy, ( name + ".CaloEnergy[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".isGoodMuonTMOneStationTight" ).c_str(), isGoodMuonTMOneStationTight, ( name + ".isGoodMuonTMOneStationTight[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".isPFMuon" ).c_str(), isPFMuon, ( name + ".isPFMuon[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".MuIDGlobalMuonPromptTight" ).c_str(), MuIDGlobalMuonPromptTight, ( name + ".MuIDGlobalMuonPromptTight[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".MuGlobalNormalizedChi2" ).c_str(), MuGlobalNormalizedChi2, ( name + ".MuGlobalNormalizedChi2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuCaloCompat" ).c_str(), MuCaloCompat, ( name + ".MuCaloCompat[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuNChambers" ).c_str(), MuNChambers, ( name + ".MuNChambers[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNChambersMatchesSegment" ).c_str(), MuNChambersMatchesSegment, ( name + ".MuNChambersMatchesSegment[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNMatchedStations" ).c_str(), MuNMatchedStations, ( name + ".MuNMatchedStations[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNLostOuterHits" ).c_str(), MuNLostOuterHits, ( name + ".MuNLostOuterHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNMuonhits" ).c_str(), MuNMuonhits, ( name + ".MuNMuonhits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuDThits" ).c_str(), MuDThits, ( name + ".MuDThits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuCSChits" ).c_str(), MuCSChits, ( name + ".MuCSChits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuRPChits" ).c_str(), MuRPChits, ( name + ".MuRPChits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuType" ).c_str(), MuType, ( name + ".MuType[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuontimenDof" ).c_str(), MuontimenDof, ( name + ".MuontimenDof[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuontimeAtIpInOut" ).c_str(), MuontimeAtIpInOut, ( name + ".MuontimeAtIpInOut[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuontimeAtIpOutIn" ).c_str(), MuontimeAtIpOutIn, ( name + ".MuontimeAtIpOutIn[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Muondirection" ).c_str(), Muondirection, ( name + ".Muondirection[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".innerTracknormalizedChi2" ).c_str(), innerTracknormalizedChi2, ( name + ".innerTracknormalizedChi2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerPtError" ).c_str(), MuInnerPtError, ( name + ".MuInnerPtError[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuGlobalPtError" ).c_str(), MuGlobalPtError, ( name + ".MuGlobalPtError[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackDz" ).c_str(), MuInnerTrackDz, ( name + ".MuInnerTrackDz[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackD0" ).c_str(), MuInnerTrackD0, ( name + ".MuInnerTrackD0[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackDxy_BS" ).c_str(), MuInnerTrackDxy_BS, ( name + ".MuInnerTrackDxy_BS[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackDxy_PV" ).c_str(), MuInnerTrackDxy_PV, ( name + ".MuInnerTrackDxy_PV[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackDxy_PVBS" ).c_str(), MuInnerTrackDxy_PVBS, ( name + ".MuInnerTrackDxy_PVBS[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuInnerTrackNHits" ).c_str(), MuInnerTrackNHits, ( name + ".MuInnerTrackNHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNTrackerHits" ).c_str(), MuNTrackerHits, ( name + ".MuNTrackerHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNLostInnerHits" ).c_str(), MuNLostInnerHits, ( name + ".MuNLostInnerHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".vertexZ" ).c_str(), vertexZ, ( name + ".vertexZ[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".MuNPixelLayers" ).c_str(), MuNPixelLayers, ( name + ".MuNPixelLayers[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNPixelLayersWMeasurement" ).c_str(), MuNPixelLayersWMeasurement, ( name + ".MuNPixelLayersWMeasurement[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".MuNTrackLayersWMeasurement" ).c_str(), MuNTrackLayersWMeasurement, ( name + ".MuNTrackLayersWMeasurement[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ChargeGsf" ).c_str(), ChargeGsf, ( name + ".ChargeGsf[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ChargeCtf" ).c_str(), ChargeCtf, ( name + ".ChargeCtf[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ChargeScPix" ).c_str(), ChargeScPix, ( name + ".ChargeScPix[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".isEcalDriven" ).c_str(), isEcalDriven, ( name + ".isEcalDriven[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".isTrackerDriven" ).c_str(), isTrackerDriven, ( name + ".isTrackerDriven[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".caloEta" ).c_str(), caloEta, ( name + ".caloEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".e1x5" ).c_str(), e1x5, ( name + ".e1x5[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".e2x5Max" ).c_str(), e2x5Max, ( name + ".e2x5Max[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".e5x5" ).c_str(), e5x5, ( name + ".e5x5[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".HcalDepth1Iso" ).c_str(), HcalDepth1Iso, ( name + ".HcalDepth1Iso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".HcalDepth2Iso" ).c_str(), HcalDepth2Iso, ( name + ".HcalDepth2Iso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EgammaMVANonTrig" ).c_str(), EgammaMVANonTrig, ( name + ".EgammaMVANonTrig[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EgammaMVATrig" ).c_str(), EgammaMVATrig, ( name + ".EgammaMVATrig[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdTRIGGERTIGHT" ).c_str(), EgammaCutBasedEleIdTRIGGERTIGHT, ( name + ".EgammaCutBasedEleIdTRIGGERTIGHT[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdTRIGGERWP70" ).c_str(), EgammaCutBasedEleIdTRIGGERWP70, ( name + ".EgammaCutBasedEleIdTRIGGERWP70[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdVETO" ).c_str(), EgammaCutBasedEleIdVETO, ( name + ".EgammaCutBasedEleIdVETO[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdLOOSE" ).c_str(), EgammaCutBasedEleIdLOOSE, ( name + ".EgammaCutBasedEleIdLOOSE[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdMEDIUM" ).c_str(), EgammaCutBasedEleIdMEDIUM, ( name + ".EgammaCutBasedEleIdMEDIUM[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdTIGHT" ).c_str(), EgammaCutBasedEleIdTIGHT, ( name + ".EgammaCutBasedEleIdTIGHT[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EgammaCutBasedEleIdHEEP" ).c_str(), EgammaCutBasedEleIdHEEP, ( name + ".EgammaCutBasedEleIdHEEP[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".Eldr03HcalDepth1TowerSumEtBc" ).c_str(), Eldr03HcalDepth1TowerSumEtBc, ( name + ".Eldr03HcalDepth1TowerSumEtBc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eldr03HcalDepth2TowerSumEtBc" ).c_str(), Eldr03HcalDepth2TowerSumEtBc, ( name + ".Eldr03HcalDepth2TowerSumEtBc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eldr04HcalDepth1TowerSumEtBc" ).c_str(), Eldr04HcalDepth1TowerSumEtBc, ( name + ".Eldr04HcalDepth1TowerSumEtBc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eldr04HcalDepth2TowerSumEtBc" ).c_str(), Eldr04HcalDepth2TowerSumEtBc, ( name + ".Eldr04HcalDepth2TowerSumEtBc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElhcalOverEcalBc" ).c_str(), ElhcalOverEcalBc, ( name + ".ElhcalOverEcalBc[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElEcalE" ).c_str(), ElEcalE, ( name + ".ElEcalE[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElEoverP" ).c_str(), ElEoverP, ( name + ".ElEoverP[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EldeltaEta" ).c_str(), EldeltaEta, ( name + ".EldeltaEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".EldeltaPhi" ).c_str(), EldeltaPhi, ( name + ".EldeltaPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElHadoverEm" ).c_str(), ElHadoverEm, ( name + ".ElHadoverEm[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElsigmaIetaIeta" ).c_str(), ElsigmaIetaIeta, ( name + ".ElsigmaIetaIeta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElscSigmaIetaIeta" ).c_str(), ElscSigmaIetaIeta, ( name + ".ElscSigmaIetaIeta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElEnergyErr" ).c_str(), ElEnergyErr, ( name + ".ElEnergyErr[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElMomentumErr" ).c_str(), ElMomentumErr, ( name + ".ElMomentumErr[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElSharedHitsFraction" ).c_str(), ElSharedHitsFraction, ( name + ".ElSharedHitsFraction[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".dR_gsf_ctfTrack" ).c_str(), dR_gsf_ctfTrack, ( name + ".dR_gsf_ctfTrack[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".dPt_gsf_ctfTrack" ).c_str(), dPt_gsf_ctfTrack, ( name + ".dPt_gsf_ctfTrack[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElhasConv" ).c_str(), ElhasConv, ( name + ".ElhasConv[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".ElTrackNHits" ).c_str(), ElTrackNHits, ( name + ".ElTrackNHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ElTrackNLostHits" ).c_str(), ElTrackNLostHits, ( name + ".ElTrackNLostHits[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackDz" ).c_str(), ElTrackDz, ( name + ".ElTrackDz[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackDz_BS" ).c_str(), ElTrackDz_BS, ( name + ".ElTrackDz_BS[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackD0" ).c_str(), ElTrackD0, ( name + ".ElTrackD0[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackDxy_BS" ).c_str(), ElTrackDxy_BS, ( name + ".ElTrackDxy_BS[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackDxy_PV" ).c_str(), ElTrackDxy_PV, ( name + ".ElTrackDxy_PV[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElTrackDxy_PVBS" ).c_str(), ElTrackDxy_PVBS, ( name + ".ElTrackDxy_PVBS[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElNClusters" ).c_str(), ElNClusters, ( name + ".ElNClusters[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ElClassification" ).c_str(), ElClassification, ( name + ".ElClassification[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".ElFBrem" ).c_str(), ElFBrem, ( name + ".ElFBrem[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NumberOfExpectedInnerHits" ).c_str(), NumberOfExpectedInnerHits, ( name + ".NumberOfExpectedInnerHits[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Eldist" ).c_str(), Eldist, ( name + ".Eldist[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eldcot" ).c_str(), Eldcot, ( name + ".Eldcot[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Elconvradius" ).c_str(), Elconvradius, ( name + ".Elconvradius[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElConvPoint_x" ).c_str(), ElConvPoint_x, ( name + ".ElConvPoint_x[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElConvPoint_y" ).c_str(), ElConvPoint_y, ( name + ".ElConvPoint_y[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElConvPoint_z" ).c_str(), ElConvPoint_z, ( name + ".ElConvPoint_z[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".dcotdist" ).c_str(), dcotdist, ( name + ".dcotdist[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElseedEoverP" ).c_str(), ElseedEoverP, ( name + ".ElseedEoverP[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElEcalIso04" ).c_str(), ElEcalIso04, ( name + ".ElEcalIso04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElHcalIso04" ).c_str(), ElHcalIso04, ( name + ".ElHcalIso04[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".ElNumberOfBrems" ).c_str(), ElNumberOfBrems, ( name + ".ElNumberOfBrems[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".TrgPt" ).c_str(), TrgPt, ( name + ".TrgPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".TrgEta" ).c_str(), TrgEta, ( name + ".TrgEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".TrgPhi" ).c_str(), TrgPhi, ( name + ".TrgPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".TrgID" ).c_str(), TrgID, ( name + ".TrgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".isPFTau" ).c_str(), isPFTau, ( name + ".isPFTau[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GenPt" ).c_str(), GenPt, ( name + ".GenPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenEta" ).c_str(), GenEta, ( name + ".GenEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPhi" ).c_str(), GenPhi, ( name + ".GenPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPdgID" ).c_str(), GenPdgID, ( name + ".GenPdgID[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".GenMCTag" ).c_str(), GenMCTag, ( name + ".GenMCTag[" + name + ".Size]/I" ).c_str() );
+   BranchBooker( TTree* tree, const std::string& prefix, const BranchFilter& filter, const std::vector<std::string>& countlist ) :
+      _tree( tree ), _namer( prefix ), _filter( filter ), _countlist( countlist ) {}
+
+   template<typename T>
+   void Scalar( const char* field, T& x, const char* type ) {
+      if( !Keep( field ) && std::find( _countlist.begin(), _countlist.end(), field ) == _countlist.end() ){ return; }
+      _tree->Branch( _namer.Name( field ), &x, _namer.Leaf( field, type ) );
    }
 
-   void Register( TTree* root, const std::string& name = "LepInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".Index" ).c_str() , Index );
-      root->SetBranchAddress( ( name + ".LeptonType" ).c_str() , LeptonType );
-      root->SetBranchAddress( ( name + ".Charge" ).c_str() , Charge );
-      root->SetBranchAddress( ( name + ".Pt" ).c_str() , Pt );
-      root->SetBranchAddress( ( name + ".Et" ).c_str() , Et );
-      root->SetBranchAddress( ( name + ".Eta" ).c_str() , Eta );
-      root->SetBranchAddress( ( name + ".Phi" ).c_str() , Phi );
-      root->SetBranchAddress( ( name + ".Px" ).c_str() , Px );
-      root->SetBranchAddress( ( name + ".Py" ).c_str() , Py );
-      root->SetBranchAddress( ( name + ".Pz" ).c_str() , Pz );
-      root->SetBranchAddress( ( name + ".Energy" ).c_str() , Energy );
-      root->SetBranchAddress( ( name + ".TrackIso" ).c_str() , TrackIso );
-      root->SetBranchAddress( ( name + ".EcalIso" ).c_str() , EcalIso );
-      root->SetBranchAddress( ( name + ".HcalIso" ).c_str() , HcalIso );
-      root->SetBranchAddress( ( name + ".ChargedHadronIso" ).c_str() , ChargedHadronIso );
-      root->SetBranchAddress( ( name + ".NeutralHadronIso" ).c_str() , NeutralHadronIso );
-      root->SetBranchAddress( ( name + ".PhotonIso" ).c_str() , PhotonIso );
-      root->SetBranchAddress( ( name + ".SumPUPt" ).c_str() , SumPUPt );
-      root->SetBranchAddress( ( name + ".ChargedHadronIsoR03" ).c_str() , ChargedHadronIsoR03 );
-      root->SetBranchAddress( ( name + ".NeutralHadronIsoR03" ).c_str() , NeutralHadronIsoR03 );
-      root->SetBranchAddress( ( name + ".PhotonIsoR03" ).c_str() , PhotonIsoR03 );
-      root->SetBranchAddress( ( name + ".sumPUPtR03" ).c_str() , sumPUPtR03 );
-      root->SetBranchAddress( ( name + ".IsoRhoCorrR03" ).c_str() , IsoRhoCorrR03 );
-      root->SetBranchAddress( ( name + ".ChargedHadronIsoR04" ).c_str() , ChargedHadronIsoR04 );
-      root->SetBranchAddress( ( name + ".NeutralHadronIsoR04" ).c_str() , NeutralHadronIsoR04 );
-      root->SetBranchAddress( ( name + ".PhotonIsoR04" ).c_str() , PhotonIsoR04 );
-      root->SetBranchAddress( ( name + ".sumPUPtR04" ).c_str() , sumPUPtR04 );
-      root->SetBranchAddress( ( name + ".IsoRhoCorrR04" ).c_str() , IsoRhoCorrR04 );
-      root->SetBranchAddress( ( name + ".Ip3dPV" ).c_str() , Ip3dPV );
-      root->SetBranchAddress( ( name + ".Ip3dPVErr" ).c_str() , Ip3dPVErr );
-      root->SetBranchAddress( ( name + ".Ip3dPVSignificance" ).c_str() , Ip3dPVSignificance );
-      root->SetBranchAddress( ( name + ".MiniIso" ).c_str() , MiniIso );
-      root->SetBranchAddress( ( name + ".CaloEnergy" ).c_str() , CaloEnergy );
-      root->SetBranchAddress( ( name + ".isGoodMuonTMOneStationTight" ).c_str() , isGoodMuonTMOneStationTight );
-      root->SetBranchAddress( ( name + ".isPFMuon" ).c_str() , isPFMuon );
-      root->SetBranchAddress( ( name + ".MuIDGlobalMuonPromptTight" ).c_str() , MuIDGlobalMuonPromptTight );
-      root->SetBranchAddress( ( name + ".MuGlobalNormalizedChi2" ).c_str() , MuGlobalNormalizedChi2 );
-      root->SetBranchAddress( ( name + ".MuCaloCompat" ).c_str() , MuCaloCompat );
-      root->SetBranchAddress( ( name + ".MuNChambers" ).c_str() , MuNChambers );
-      root->SetBranchAddress( ( name + ".MuNChambersMatchesSegment" ).c_str() , MuNChambersMatchesSegment );
-      root->SetBranchAddress( ( name + ".MuNMatchedStations" ).c_str() , MuNMatchedStations );
-      root->SetBranchAddress( ( name + ".MuNLostOuterHits" ).c_str() , MuNLostOuterHits );
-      root->SetBranchAddress( ( name + ".MuNMuonhits" ).c_str() , MuNMuonhits );
-      root->SetBranchAddress( ( name + ".MuDThits" ).c_str() , MuDThits );
-      root->SetBranchAddress( ( name + ".MuCSChits" ).c_str() , MuCSChits );
-      root->SetBranchAddress( ( name + ".MuRPChits" ).c_str() , MuRPChits );
-      root->SetBranchAddress( ( name + ".MuType" ).c_str() , MuType );
-      root->SetBranchAddress( ( name + ".MuontimenDof" ).c_str() , MuontimenDof );
-      root->SetBranchAddress( ( name + ".MuontimeAtIpInOut" ).c_str() , MuontimeAtIpInOut );
-      root->SetBranchAddress( ( name + ".MuontimeAtIpOutIn" ).c_str() , MuontimeAtIpOutIn );
-      root->SetBranchAddress( ( name + ".Muondirection" ).c_str() , Muondirection );
-      root->SetBranchAddress( ( name + ".innerTracknormalizedChi2" ).c_str() , innerTracknormalizedChi2 );
-      root->SetBranchAddress( ( name + ".MuInnerPtError" ).c_str() , MuInnerPtError );
-      root->SetBranchAddress( ( name + ".MuGlobalPtError" ).c_str() , MuGlobalPtError );
-      root->SetBranchAddress( ( name + ".MuInnerTrackDz" ).c_str() , MuInnerTrackDz );
-      root->SetBranchAddress( ( name + ".MuInnerTrackD0" ).c_str() , MuInnerTrackD0 );
-      root->SetBranchAddress( ( name + ".MuInnerTrackDxy_BS" ).c_str() , MuInnerTrackDxy_BS );
-      root->SetBranchAddress( ( name + ".MuInnerTrackDxy_PV" ).c_str() , MuInnerTrackDxy_PV );
-      root->SetBranchAddress( ( name + ".MuInnerTrackDxy_PVBS" ).c_str() , MuInnerTrackDxy_PVBS );
-      root->SetBranchAddress( ( name + ".MuInnerTrackNHits" ).c_str() , MuInnerTrackNHits );
-      root->SetBranchAddress( ( name + ".MuNTrackerHits" ).c_str() , MuNTrackerHits );
-      root->SetBranchAddress( ( name + ".MuNLostInnerHits" ).c_str() , MuNLostInnerHits );
-      root->SetBranchAddress( ( name + ".vertexZ" ).c_str() , vertexZ );
-      root->SetBranchAddress( ( name + ".MuNPixelLayers" ).c_str() , MuNPixelLayers );
-      root->SetBranchAddress( ( name + ".MuNPixelLayersWMeasurement" ).c_str() , MuNPixelLayersWMeasurement );
-      root->SetBranchAddress( ( name + ".MuNTrackLayersWMeasurement" ).c_str() , MuNTrackLayersWMeasurement );
-      root->SetBranchAddress( ( name + ".ChargeGsf" ).c_str() , ChargeGsf );
-      root->SetBranchAddress( ( name + ".ChargeCtf" ).c_str() , ChargeCtf );
-      root->SetBranchAddress( ( name + ".ChargeScPix" ).c_str() , ChargeScPix );
-      root->SetBranchAddress( ( name + ".isEcalDriven" ).c_str() , isEcalDriven );
-      root->SetBranchAddress( ( name + ".isTrackerDriven" ).c_str() , isTrackerDriven );
-      root->SetBranchAddress( ( name + ".caloEta" ).c_str() , caloEta );
-      root->SetBranchAddress( ( name + ".e1x5" ).c_str() , e1x5 );
-      root->SetBranchAddress( ( name + ".e2x5Max" ).c_str() , e2x5Max );
-      root->SetBranchAddress( ( name + ".e5x5" ).c_str() , e5x5 );
-      root->SetBranchAddress( ( name + ".HcalDepth1Iso" ).c_str() , HcalDepth1Iso );
-      root->SetBranchAddress( ( name + ".HcalDepth2Iso" ).c_str() , HcalDepth2Iso );
-      root->SetBranchAddress( ( name + ".EgammaMVANonTrig" ).c_str() , EgammaMVANonTrig );
-      root->SetBranchAddress( ( name + ".EgammaMVATrig" ).c_str() , EgammaMVATrig );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdTRIGGERTIGHT" ).c_str() , EgammaCutBasedEleIdTRIGGERTIGHT );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdTRIGGERWP70" ).c_str() , EgammaCutBasedEleIdTRIGGERWP70 );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdVETO" ).c_str() , EgammaCutBasedEleIdVETO );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdLOOSE" ).c_str() , EgammaCutBasedEleIdLOOSE );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdMEDIUM" ).c_str() , EgammaCutBasedEleIdMEDIUM );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdTIGHT" ).c_str() , EgammaCutBasedEleIdTIGHT );
-      root->SetBranchAddress( ( name + ".EgammaCutBasedEleIdHEEP" ).c_str() , EgammaCutBasedEleIdHEEP );
-      root->SetBranchAddress( ( name + ".Eldr03HcalDepth1TowerSumEtBc" ).c_str() , Eldr03HcalDepth1TowerSumEtBc );
-      root->SetBranchAddress( ( name + ".Eldr03HcalDepth2TowerSumEtBc" ).c_str() , Eldr03HcalDepth2TowerSumEtBc );
-      root->SetBranchAddress( ( name + ".Eldr04HcalDepth1TowerSumEtBc" ).c_str() , Eldr04HcalDepth1TowerSumEtBc );
-      root->SetBranchAddress( ( name + ".Eldr04HcalDepth2TowerSumEtBc" ).c_str() , Eldr04HcalDepth2TowerSumEtBc );
-      root->SetBranchAddress( ( name + ".ElhcalOverEcalBc" ).c_str() , ElhcalOverEcalBc );
-      root->SetBranchAddress( ( name + ".ElEcalE" ).c_str() , ElEcalE );
-      root->SetBranchAddress( ( name + ".ElEoverP" ).c_str() , ElEoverP );
-      root->SetBranchAddress( ( name + ".EldeltaEta" ).c_str() , EldeltaEta );
-      root->SetBranchAddress( ( name + ".EldeltaPhi" ).c_str() , EldeltaPhi );
-      root->SetBranchAddress( ( name + ".ElHadoverEm" ).c_str() , ElHadoverEm );
-      root->SetBranchAddress( ( name + ".ElsigmaIetaIeta" ).c_str() , ElsigmaIetaIeta );
-      root->SetBranchAddress( ( name + ".ElscSigmaIetaIeta" ).c_str() , ElscSigmaIetaIeta );
-      root->SetBranchAddress( ( name + ".ElEnergyErr" ).c_str() , ElEnergyErr );
-      root->SetBranchAddress( ( name + ".ElMomentumErr" ).c_str() , ElMomentumErr );
-      root->SetBranchAddress( ( name + ".ElSharedHitsFraction" ).c_str() , ElSharedHitsFraction );
-      root->SetBranchAddress( ( name + ".dR_gsf_ctfTrack" ).c_str() , dR_gsf_ctfTrack );
-      root->SetBranchAddress( ( name + ".dPt_gsf_ctfTrack" ).c_str() , dPt_gsf_ctfTrack );
-      root->SetBranchAddress( ( name + ".ElhasConv" ).c_str() , ElhasConv );
-      root->SetBranchAddress( ( name + ".ElTrackNHits" ).c_str() , ElTrackNHits );
-      root->SetBranchAddress( ( name + ".ElTrackNLostHits" ).c_str() , ElTrackNLostHits );
-      root->SetBranchAddress( ( name + ".ElTrackDz" ).c_str() , ElTrackDz );
-      root->SetBranchAddress( ( name + ".ElTrackDz_BS" ).c_str() , ElTrackDz_BS );
-      root->SetBranchAddress( ( name + ".ElTrackD0" ).c_str() , ElTrackD0 );
-      root->SetBranchAddress( ( name + ".ElTrackDxy_BS" ).c_str() , ElTrackDxy_BS );
-      root->SetBranchAddress( ( name + ".ElTrackDxy_PV" ).c_str() , ElTrackDxy_PV );
-      root->SetBranchAddress( ( name + ".ElTrackDxy_PVBS" ).c_str() , ElTrackDxy_PVBS );
-      root->SetBranchAddress( ( name + ".ElNClusters" ).c_str() , ElNClusters );
-      root->SetBranchAddress( ( name + ".ElClassification" ).c_str() , ElClassification );
-      root->SetBranchAddress( ( name + ".ElFBrem" ).c_str() , ElFBrem );
-      root->SetBranchAddress( ( name + ".NumberOfExpectedInnerHits" ).c_str() , NumberOfExpectedInnerHits );
-      root->SetBranchAddress( ( name + ".Eldist" ).c_str() , Eldist );
-      root->SetBranchAddress( ( name + ".Eldcot" ).c_str() , Eldcot );
-      root->SetBranchAddress( ( name + ".Elconvradius" ).c_str() , Elconvradius );
-      root->SetBranchAddress( ( name + ".ElConvPoint_x" ).c_str() , ElConvPoint_x );
-      root->SetBranchAddress( ( name + ".ElConvPoint_y" ).c_str() , ElConvPoint_y );
-      root->SetBranchAddress( ( name + ".ElConvPoint_z" ).c_str() , ElConvPoint_z );
-      root->SetBranchAddress( ( name + ".dcotdist" ).c_str() , dcotdist );
-      root->SetBranchAddress( ( name + ".ElseedEoverP" ).c_str() , ElseedEoverP );
-      root->SetBranchAddress( ( name + ".ElEcalIso04" ).c_str() , ElEcalIso04 );
-      root->SetBranchAddress( ( name + ".ElHcalIso04" ).c_str() , ElHcalIso04 );
-      root->SetBranchAddress( ( name + ".ElNumberOfBrems" ).c_str() , ElNumberOfBrems );
-      root->SetBranchAddress( ( name + ".TrgPt" ).c_str() , TrgPt );
-      root->SetBranchAddress( ( name + ".TrgEta" ).c_str() , TrgEta );
-      root->SetBranchAddress( ( name + ".TrgPhi" ).c_str() , TrgPhi );
-      root->SetBranchAddress( ( name + ".TrgID" ).c_str() , TrgID );
-      root->SetBranchAddress( ( name + ".isPFTau" ).c_str() , isPFTau );
-      root->SetBranchAddress( ( name + ".GenPt" ).c_str() , GenPt );
-      root->SetBranchAddress( ( name + ".GenEta" ).c_str() , GenEta );
-      root->SetBranchAddress( ( name + ".GenPhi" ).c_str() , GenPhi );
-      root->SetBranchAddress( ( name + ".GenPdgID" ).c_str() , GenPdgID );
-      root->SetBranchAddress( ( name + ".GenMCTag" ).c_str() , GenMCTag );
+   template<typename T, size_t N>
+   void Array( const char* field, T (&x)[N], const char* type ) {
+      if( !Keep( field ) ){ return; }
+      _tree->Branch( _namer.Name( field ), x, _namer.Leaf( field, N, type ) );
    }
+
+   template<typename T, size_t N>
+   void VarArray( const char* field, T (&x)[N], const char* countfield, Int_t&, const char* type ) {
+      if( !Keep( field ) ){ return; }
+      _tree->Branch( _namer.Name( field ), x, _namer.Leaf( field, countfield, type ) );
+   }
+
+   template<typename T>
+   void Vector( const char* field, std::vector<T>& w, std::vector<T>*& ) {
+      if( !Keep( field ) ){ return; }
+      _tree->Branch( _namer.Name( field ), &w );
+   }
+
+   template<size_t N>
+   void String( const char* field, Char_t (&x)[N] ) {
+      if( !Keep( field ) ){ return; }
+      _tree->Branch( _namer.Name( field ), x, _namer.Leaf( field, "C" ) );
+   }
+
+private:
+   TTree* _tree;
+   BranchNamer _namer;
+   const BranchFilter& _filter;
+   const std::vector<std::string>& _countlist;
+
+   bool Keep( const char* field ) { return _filter.Pass( field, _namer.Name( field ) ); }
 };
 
-class PhotonInfoBranches {
+// Setting the branch addresses for reading
+class BranchReader {
 public:
-   Int_t Size;
-   Float_t Pt [MAX_PHOTONS];
-   Float_t Eta [MAX_PHOTONS];
-   Float_t Phi [MAX_PHOTONS];
-   Float_t HoverE [MAX_PHOTONS];
-   Float_t SigmaIetaIeta [MAX_PHOTONS];
-   Float_t hadTowOverEm [MAX_PHOTONS];
-   Float_t hcalIsoConeDR04_2012 [MAX_PHOTONS];
-   Float_t phoPFChIso [MAX_PHOTONS];
-   Float_t phoPFNeuIso [MAX_PHOTONS];
-   Float_t phoPFPhoIso [MAX_PHOTONS];
-   Float_t sigmaIetaIeta [MAX_PHOTONS];
-   Float_t isoChEffArea [MAX_PHOTONS];
-   Float_t isoNeuEffArea [MAX_PHOTONS];
-   Float_t isoPhoEffArea [MAX_PHOTONS];
-   Bool_t phoPassLoose [MAX_PHOTONS];
-   Bool_t phoPassMedium [MAX_PHOTONS];
-   Bool_t phoPassTight [MAX_PHOTONS];
-   Float_t r9 [MAX_PHOTONS];
-   Bool_t passelectronveto [MAX_PHOTONS];
-   Bool_t hasPixelSeed [MAX_PHOTONS];
-   Float_t EcalIso [MAX_PHOTONS];
-   Float_t HcalIso [MAX_PHOTONS];
-   Float_t TrackIso [MAX_PHOTONS];
-   Float_t GenPt [MAX_PHOTONS];
-   Float_t GenEta [MAX_PHOTONS];
-   Float_t GenPhi [MAX_PHOTONS];
-   Int_t GenPdgID [MAX_PHOTONS];
-
-   void RegisterTree( TTree* root, const std::string& name = "PhotonInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".Pt" ).c_str(), Pt, ( name + ".Pt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta" ).c_str(), Eta, ( name + ".Eta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi" ).c_str(), Phi, ( name + ".Phi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".HoverE" ).c_str(), HoverE, ( name + ".HoverE[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".SigmaIetaIeta" ).c_str(), SigmaIetaIeta, ( name + ".SigmaIetaIeta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".hadTowOverEm" ).c_str(), hadTowOverEm, ( name + ".hadTowOverEm[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".hcalIsoConeDR04_2012" ).c_str(), hcalIsoConeDR04_2012, ( name + ".hcalIsoConeDR04_2012[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".phoPFChIso" ).c_str(), phoPFChIso, ( name + ".phoPFChIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".phoPFNeuIso" ).c_str(), phoPFNeuIso, ( name + ".phoPFNeuIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".phoPFPhoIso" ).c_str(), phoPFPhoIso, ( name + ".phoPFPhoIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".sigmaIetaIeta" ).c_str(), sigmaIetaIeta, ( name + ".sigmaIetaIeta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".isoChEffArea" ).c_str(), isoChEffArea, ( name + ".isoChEffArea[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".isoNeuEffArea" ).c_str(), isoNeuEffArea, ( name + ".isoNeuEffArea[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".isoPhoEffArea" ).c_str(), isoPhoEffArea, ( name + ".isoPhoEffArea[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".phoPassLoose" ).c_str(), phoPassLoose, ( name + ".phoPassLoose[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".phoPassMedium" ).c_str(), phoPassMedium, ( name + ".phoPassMedium[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".phoPassTight" ).c_str(), phoPassTight, ( name + ".phoPassTight[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".r9" ).c_str(), r9, ( name + ".r9[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".passelectronveto" ).c_str(), passelectronveto, ( name + ".passelectronveto[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".hasPixelSeed" ).c_str(), hasPixelSeed, ( name + ".hasPixelSeed[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".EcalIso" ).c_str(), EcalIso, ( name + ".EcalIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".HcalIso" ).c_str(), HcalIso, ( name + ".HcalIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".TrackIso" ).c_str(), TrackIso, ( name + ".TrackIso[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPt" ).c_str(), GenPt, ( name + ".GenPt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenEta" ).c_str(), GenEta, ( name + ".GenEta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPhi" ).c_str(), GenPhi, ( name + ".GenPhi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".GenPdgID" ).c_str(), GenPdgID, ( name + ".GenPdgID[" + name + ".Size]/I" ).c_str() );
+   BranchReader( TTree* tree, const std::string& prefix ) : _tree( tree ), _namer( prefix ) {}
+
+   template<typename T>
+   void Scalar( const char* field, T& x, const char* ) {
+      if( !Exists( field ) ){ return; }
+      _tree->SetBranchAddress( _namer.Name( field ), &x );
+   }
+
+   template<typename T, size_t N>
+   void Array( const char* field, T (&x)[N], const char* ) {
+      if( !Exists( field ) ){ return; }
+      _tree->SetBranchAddress( _namer.Name( field ), x );
    }
 
-   void Register( TTree* root, const std::string& name = "PhotonInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".Pt" ).c_str() , Pt );
-      root->SetBranchAddress( ( name + ".Eta" ).c_str() , Eta );
-      root->SetBranchAddress( ( name + ".Phi" ).c_str() , Phi );
-      root->SetBranchAddress( ( name + ".HoverE" ).c_str() , HoverE );
-      root->SetBranchAddress( ( name + ".SigmaIetaIeta" ).c_str() , SigmaIetaIeta );
-      root->SetBranchAddress( ( name + ".hadTowOverEm" ).c_str() , hadTowOverEm );
-      root->SetBranchAddress( ( name + ".hcalIsoConeDR04_2012" ).c_str() , hcalIsoConeDR04_2012 );
-      root->SetBranchAddress( ( name + ".phoPFChIso" ).c_str() , phoPFChIso );
-      root->SetBranchAddress( ( name + ".phoPFNeuIso" ).c_str() , phoPFNeuIso );
-      root->SetBranchAddress( ( name + ".phoPFPhoIso" ).c_str() , phoPFPhoIso );
-      root->SetBranchAddress( ( name + ".sigmaIetaIeta" ).c_str() , sigmaIetaIeta );
-      root->SetBranchAddress( ( name + ".isoChEffArea" ).c_str() , isoChEffArea );
-      root->SetBranchAddress( ( name + ".isoNeuEffArea" ).c_str() , isoNeuEffArea );
-      root->SetBranchAddress( ( name + ".isoPhoEffArea" ).c_str() , isoPhoEffArea );
-      root->SetBranchAddress( ( name + ".phoPassLoose" ).c_str() , phoPassLoose );
-      root->SetBranchAddress( ( name + ".phoPassMedium" ).c_str() , phoPassMedium );
-      root->SetBranchAddress( ( name + ".phoPassTight" ).c_str() , phoPassTight );
-      root->SetBranchAddress( ( name + ".r9" ).c_str() , r9 );
-      root->SetBranchAddress( ( name + ".passelectronveto" ).c_str() , passelectronveto );
-      root->SetBranchAddress( ( name + ".hasPixelSeed" ).c_str() , hasPixelSeed );
-      root->SetBranchAddress( ( name + ".EcalIso" ).c_str() , EcalIso );
-      root->SetBranchAddress( ( name + ".HcalIso" ).c_str() , HcalIso );
-      root->SetBranchAddress( ( name + ".TrackIso" ).c_str() , TrackIso );
-      root->SetBranchAddress( ( name + ".GenPt" ).c_str() , GenPt );
-      root->SetBranchAddress( ( name + ".GenEta" ).c_str() , GenEta );
-      root->SetBranchAddress( ( name + ".GenPhi" ).c_str() , GenPhi );
-      root->SetBranchAddress( ( name + ".GenPdgID" ).c_str() , GenPdgID );
+   template<typename T, size_t N>
+   void VarArray( const char* field, T (&x)[N], const char*, Int_t&, const char* ) {
+      if( !Exists( field ) ){ return; }
+      _tree->SetBranchAddress( _namer.Name( field ), x );
    }
+
+   template<typename T>
+   void Vector( const char* field, std::vector<T>&, std::vector<T>*& r ) {
+      r = 0;
+      if( !Exists( field ) ){ return; }
+      _tree->SetBranchAddress( _namer.Name( field ), &r );
+   }
+
+   template<size_t N>
+   void String( const char* field, Char_t (&x)[N] ) {
+      if( !Exists( field ) ){ return; }
+      _tree->SetBranchAddress( _namer.Name( field ), x );
+   }
+
+private:
+   TTree* _tree;
+   BranchNamer _namer;
+
+   // Branches dropped when writing are skipped
+   bool Exists( const char* field ) { return _tree->GetBranch( _namer.Name( field ) ) != 0; }
 };
 
-class TrgInfoBranches {
+// Clearing the arrays and vectors, must be run before the scalars are cleared,
+// as the variable length arrays are cleared up to their current count.
+class ArrayResetter {
 public:
-   Int_t Size;
-   Int_t TriggerBit [MAX_TRGOBJS];
-   Int_t FilterLabel [MAX_TRGOBJS];
-   Float_t Pt [MAX_TRGOBJS];
-   Float_t Eta [MAX_TRGOBJS];
-   Float_t Phi [MAX_TRGOBJS];
-   Float_t Energy [MAX_TRGOBJS];
-
-   void RegisterTree( TTree* root, const std::string& name = "TrgInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".TriggerBit" ).c_str(), TriggerBit, ( name + ".TriggerBit[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".FilterLabel" ).c_str(), FilterLabel, ( name + ".FilterLabel[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Pt" ).c_str(), Pt, ( name + ".Pt[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Eta" ).c_str(), Eta, ( name + ".Eta[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Phi" ).c_str(), Phi, ( name + ".Phi[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Energy" ).c_str(), Energy, ( name + ".Energy[" + name + ".Size]/F" ).c_str() );
+   explicit ArrayResetter( const bool full ) : _full( full ) {}
+
+   template<typename T>
+   void Scalar( const char*, T&, const char* ) {}
+
+   template<typename T, size_t N>
+   void Array( const char*, T (&x)[N], const char* ) { ResetArray( x ); }
+
+   template<typename T, size_t N>
+   void VarArray( const char*, T (&x)[N], const char*, Int_t& count, const char* ) { ResetArray( x, count, _full ); }
+
+   template<typename T>
+   void Vector( const char*, std::vector<T>& w, std::vector<T>*& r ) {
+      w.clear();
+      if( _full ){ r = 0; }
    }
 
-   void Register( TTree* root, const std::string& name = "TrgInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".TriggerBit" ).c_str() , TriggerBit );
-      root->SetBranchAddress( ( name + ".FilterLabel" ).c_str() , FilterLabel );
-      root->SetBranchAddress( ( name + ".Pt" ).c_str() , Pt );
-      root->SetBranchAddress( ( name + ".Eta" ).c_str() , Eta );
-      root->SetBranchAddress( ( name + ".Phi" ).c_str() , Phi );
-      root->SetBranchAddress( ( name + ".Energy" ).c_str() , Energy );
+   template<size_t N>
+   void String( const char*, Char_t (&x)[N] ) { ResetArray( x ); }
+
+private:
+   const bool _full;
+};
+
+// Clearing the scalars
+class ScalarResetter {
+public:
+   template<typename T>
+   void Scalar( const char*, T& x, const char* ) { x = 0; }
+
+   template<typename T, size_t N>
+   void Array( const char*, T (&)[N], const char* ) {}
+
+   template<typename T, size_t N>
+   void VarArray( const char*, T (&)[N], const char*, Int_t&, const char* ) {}
+
+   template<typename T>
+   void Vector( const char*, std::vector<T>&, std::vector<T>*& ) {}
+
+   template<size_t N>
+   void String( const char*, Char_t (&)[N] ) {}
+};
+
+// Number of bytes holding the current content, for size accounting
+class BranchSizer {
+public:
+   BranchSizer() : _bytes( 0 ) {}
+
+   template<typename T>
+   void Scalar( const char*, T&, const char* ) { _bytes += sizeof( T ); }
+
+   template<typename T, size_t N>
+   void Array( const char*, T (&)[N], const char* ) { _bytes += N * sizeof( T ); }
+
+   template<typename T, size_t N>
+   void VarArray( const char*, T (&)[N], const char*, Int_t& count, const char* ) {
+      _bytes += std::min( N, (size_t)std::max( count, 0 ) ) * sizeof( T );
    }
+
+   template<typename T>
+   void Vector( const char*, std::vector<T>& w, std::vector<T>*& ) { _bytes += w.size() * sizeof( T ); }
+
+   template<size_t N>
+   void String( const char*, Char_t (&x)[N] ) { _bytes += strnlen( x, N ) + 1; }
+
+   size_t Bytes() const { return _bytes; }
+
+private:
+   size_t _bytes;
 };
 
-class VertexInfoBranches {
+}
+
+//-------------------------  Field table expansion macros  --------------------------
+#define BPK_DECLARE_SCALAR( type, field, leaf )              type field;
+#define BPK_DECLARE_ARRAY( type, field, size, leaf )         type field [size];
+#define BPK_DECLARE_VARRAY( type, field, size, count, leaf ) type field [size];
+#define BPK_DECLARE_VECTOR( type, field )                    std::vector<type>* field; std::vector<type> field ## _w;
+#define BPK_DECLARE_STRING( type, field, size )              type field [size];
+
+#define BPK_VISIT_SCALAR( type, field, leaf )              v.Scalar( #field, field, #leaf );
+#define BPK_VISIT_ARRAY( type, field, size, leaf )         v.Array( #field, field, #leaf );
+#define BPK_VISIT_VARRAY( type, field, size, count, leaf ) v.VarArray( #field, field, #count, count, #leaf );
+#define BPK_VISIT_VECTOR( type, field )                    v.Vector( #field, field ## _w, field );
+#define BPK_VISIT_STRING( type, field, size )              v.String( #field, field );
+
+#define BPK_BRANCH_CLASS( classname, FIELDS, defaultname )                                                        \
+public:                                                                                                           \
+   FIELDS( BPK_DECLARE_SCALAR, BPK_DECLARE_ARRAY, BPK_DECLARE_VARRAY, BPK_DECLARE_VECTOR, BPK_DECLARE_STRING )    \
+                                                                                                                  \
+   classname() { Reset( true ); }                                                                                 \
+                                                                                                                  \
+   template<typename Visitor>                                                                                     \
+   void Visit( Visitor& v ) {                                                                                     \
+      FIELDS( BPK_VISIT_SCALAR, BPK_VISIT_ARRAY, BPK_VISIT_VARRAY, BPK_VISIT_VECTOR, BPK_VISIT_STRING )           \
+   }                                                                                                              \
+                                                                                                                  \
+   /* Clearing the entries written in the previous event, or everything if full */                               \
+   void Reset( const bool full = false ) {                                                                        \
+      bpk::ArrayResetter arrayresetter( full );                                                                   \
+      Visit( arrayresetter );                                                                                     \
+      bpk::ScalarResetter scalarresetter;                                                                         \
+      Visit( scalarresetter );                                                                                    \
+   }                                                                                                              \
+                                                                                                                  \
+   void RegisterTree( TTree* root, const std::string& name = defaultname,                                         \
+                      const bpk::BranchFilter& filter = bpk::BranchFilter() ) {                                   \
+      bpk::CountCollector counts( name, filter );                                                                 \
+      Visit( counts );                                                                                            \
+      bpk::BranchBooker booker( root, name, filter, counts.CountList() );                                         \
+      Visit( booker );                                                                                            \
+   }                                                                                                              \
+                                                                                                                  \
+   void Register( TTree* root, const std::string& name = defaultname ) {                                          \
+      bpk::BranchReader reader( root, name );                                                                     \
+      Visit( reader );                                                                                            \
+   }                                                                                                              \
+                                                                                                                  \
+   size_t FilledBytes() const {                                                                                   \
+      bpk::BranchSizer sizer;                                                                                     \
+      const_cast<classname*>( this )->Visit( sizer );                                                             \
+      return sizer.Bytes();                                                                                       \
+   }
+
+#define BPK_EVTINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING )                                \
+   SCALAR( Int_t,     RunNo,                                     I )                               \
+   SCALAR( ULong64_t, EvtNo,                                     l )                               \
+   SCALAR( Int_t,     BxNo,                                      I )                               \
+   SCALAR( Int_t,     LumiNo,                                    I )                               \
+   SCALAR( Int_t,     Orbit,                                     I )                               \
+   SCALAR( Bool_t,    McIsTZTZ,                                  O )                               \
+   SCALAR( Bool_t,    McIsTHTH,                                  O )                               \
+   SCALAR( Bool_t,    McIsTZTH,                                  O )                               \
+   SCALAR( Bool_t,    McIsTZBW,                                  O )                               \
+   SCALAR( Bool_t,    McIsTHBW,                                  O )                               \
+   SCALAR( Bool_t,    McIsBWBW,                                  O )                               \
+   SCALAR( Int_t,     McFlag,                                    I )                               \
+   SCALAR( Int_t,     McSigTag,                                  I )                               \
+   ARRAY ( Int_t,     McbprimeMode,                              2, I )                            \
+   ARRAY ( Int_t,     MctprimeMode,                              2, I )                            \
+   ARRAY ( Int_t,     McWMode,                                   4, I )                            \
+   ARRAY ( Int_t,     McZMode,                                   2, I )                            \
+   ARRAY ( Float_t,   McbprimeMass,                              2, F )                            \
+   ARRAY ( Float_t,   MctprimeMass,                              2, F )                            \
+   ARRAY ( Float_t,   MctopMass,                                 2, F )                            \
+   ARRAY ( Float_t,   McWMass,                                   4, F )                            \
+   ARRAY ( Float_t,   McZMass,                                   2, F )                            \
+   ARRAY ( Float_t,   McDauPt,                                   14, F )                           \
+   ARRAY ( Float_t,   McDauEta,                                  14, F )                           \
+   ARRAY ( Float_t,   McDauPhi,                                  14, F )                           \
+   ARRAY ( Int_t,     McDauPdgID,                                14, I )                           \
+   SCALAR( Float_t,   Rho,                                       F )                               \
+   ARRAY ( Float_t,   RhoPU,                                     2, F )                            \
+   ARRAY ( Float_t,   SigmaPU,                                   2, F )                            \
+   SCALAR( Float_t,   BeamSpotX,                                 F )                               \
+   SCALAR( Float_t,   BeamSpotY,                                 F )                               \
+   SCALAR( Float_t,   BeamSpotZ,                                 F )                               \
+   SCALAR( Int_t,     nBX,                                       I )                               \
+   VARRAY( Int_t,     nPU,                                       MAX_BX, nBX, I )                  \
+   VARRAY( Int_t,     BXPU,                                      MAX_BX, nBX, I )                  \
+   VARRAY( Float_t,   TrueIT,                                    MAX_BX, nBX, F )                  \
+   SCALAR( Int_t,     PDFid1,                                    I )                               \
+   SCALAR( Int_t,     PDFid2,                                    I )                               \
+   SCALAR( Float_t,   PDFx1,                                     F )                               \
+   SCALAR( Float_t,   PDFx2,                                     F )                               \
+   SCALAR( Float_t,   PDFscale,                                  F )                               \
+   SCALAR( Float_t,   PDFv1,                                     F )                               \
+   SCALAR( Float_t,   PDFv2,                                     F )                               \
+   SCALAR( Float_t,   PFMET,                                     F )                               \
+   SCALAR( Float_t,   PFMETType1CorrectedPFMetUnclusteredEnUp,   F )                               \
+   SCALAR( Float_t,   PFMETType1CorrectedPFMetUnclusteredEnDown, F )                               \
+   SCALAR( Float_t,   PFMETPhi,                                  F )                               \
+   SCALAR( Float_t,   PFRawMET,                                  F )                               \
+   SCALAR( Float_t,   PFRawMETPhi,                               F )                               \
+   SCALAR( Float_t,   PFSumEt,                                   F )                               \
+   SCALAR( Float_t,   PFMETSig,                                  F )                               \
+   SCALAR( Float_t,   PFMETlongitudinal,                         F )                               \
+   SCALAR( Float_t,   PFMETRealSig,                              F )                               \
+   SCALAR( Float_t,   PFGenMET,                                  F )                               \
+   SCALAR( Float_t,   PFGenMETPhi,                               F )                               \
+   SCALAR( Float_t,   PFMETx,                                    F )                               \
+   SCALAR( Float_t,   PFMETy,                                    F )                               \
+   SCALAR( Float_t,   PuppiMET,                                  F )                               \
+   SCALAR( Float_t,   PuppiMETPhi,                               F )                               \
+   SCALAR( Float_t,   PuppiRawMET,                               F )                               \
+   SCALAR( Float_t,   PuppiRawMETPhi,                            F )                               \
+   SCALAR( Float_t,   PuppiSumEt,                                F )                               \
+   SCALAR( Float_t,   PuppiMETSig,                               F )                               \
+   SCALAR( Float_t,   PuppiMETlongitudinal,                      F )                               \
+   SCALAR( Float_t,   PuppiMETRealSig,                           F )                               \
+   SCALAR( Float_t,   PuppiGenMET,                               F )                               \
+   SCALAR( Float_t,   PuppiGenMETPhi,                            F )                               \
+   SCALAR( Int_t,     TrgCount,                                  I )                               \
+   SCALAR( Int_t,     nTrgBook,                                  I )                               \
+   VARRAY( Char_t,    TrgBook,                                   N_TRIGGER_BOOKINGS, nTrgBook, C ) \
+   SCALAR( Int_t,     nHLT,                                      I )                               \
+   SCALAR( Float_t,   HighPurityFraction,                        F )                               \
+   SCALAR( Int_t,     NofTracks,                                 I )                               \
+   SCALAR( Float_t,   ptHat,                                     F )                               \
+   VARRAY( Int_t,     HLTPrescaleFactor,                         MAX_HLTPATHS, nHLT, I )           \
+   VARRAY( Int_t,     HLTName2enum,                              MAX_HLTPATHS, nHLT, I )           \
+   VARRAY( Bool_t,    HLTbits,                                   N_TRIGGER_BOOKINGS, nHLT, O )     \
+   ARRAY ( Int_t,     L1,                                        128, I )                          \
+   ARRAY ( Int_t,     TT,                                        64, I )                           \
+   SCALAR( Int_t,     nTrgBookPacked,                            I )                               \
+   VARRAY( UInt_t,    TrgBookPacked,                             N_TRGBOOK_WORDS, nTrgBookPacked, i ) \
+   SCALAR( Int_t,     nHLTbitsPacked,                            I )                               \
+   VARRAY( UInt_t,    HLTbitsPacked,                             N_HLTBITS_WORDS, nHLTbitsPacked, i ) \
+   SCALAR( Int_t,     nTrgFamily,                                I )                               \
+   VARRAY( Char_t,    TrgFamily,                                 MAX_TRGFAMILIES, nTrgFamily, B ) \
+   SCALAR( Int_t,     HLTPrescaleColumn,                         I )                               \
+   SCALAR( Int_t,     nL1Packed,                                 I )                               \
+   VARRAY( ULong64_t, L1Packed,                                  N_L1_WORDS, nL1Packed, l )        \
+   SCALAR( Int_t,     nTTPacked,                                 I )                               \
+   VARRAY( ULong64_t, TTPacked,                                  N_TT_WORDS, nTTPacked, l )
+
+class RunInfoBranches;
+
+class EvtInfoBranches {
+   BPK_BRANCH_CLASS( EvtInfoBranches, BPK_EVTINFO_FIELDS, "EvtInfo" )
+
 public:
-   Int_t Size;
-   Int_t isValid [MAX_Vertices];
-   Bool_t isFake [MAX_Vertices];
-   Int_t Type [MAX_Vertices];
-   Float_t Ndof [MAX_Vertices];
-   Float_t NormalizedChi2 [MAX_Vertices];
-   Float_t Pt_Sum [MAX_Vertices];
-   Float_t Pt_Sum2 [MAX_Vertices];
-   Float_t x [MAX_Vertices];
-   Float_t y [MAX_Vertices];
-   Float_t z [MAX_Vertices];
-   Float_t Rho [MAX_Vertices];
-
-   void RegisterTree( TTree* root, const std::string& name = "VertexInfo" ) {
-      root->Branch( ( name + ".Size" ).c_str(), &Size, ( name + "Size/I" ).c_str() );
-      root->Branch( ( name + ".isValid" ).c_str(), isValid, ( name + ".isValid[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".isFake" ).c_str(), isFake, ( name + ".isFake[" + name + ".Size]/O" ).c_str() );
-      root->Branch( ( name + ".Type" ).c_str(), Type, ( name + ".Type[" + name + ".Size]/I" ).c_str() );
-      root->Branch( ( name + ".Ndof" ).c_str(), Ndof, ( name + ".Ndof[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".NormalizedChi2" ).c_str(), NormalizedChi2, ( name + ".NormalizedChi2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Pt_Sum" ).c_str(), Pt_Sum, ( name + ".Pt_Sum[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Pt_Sum2" ).c_str(), Pt_Sum2, ( name + ".Pt_Sum2[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".x" ).c_str(), x, ( name + ".x[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".y" ).c_str(), y, ( name + ".y[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".z" ).c_str(), z, ( name + ".z[" + name + ".Size]/F" ).c_str() );
-      root->Branch( ( name + ".Rho" ).c_str(), Rho, ( name + ".Rho[" + name + ".Size]/F" ).c_str() );
+   // Rebuilding HLTName2enum and HLTPrescaleFactor from the run information of
+   // the event run, for files written with runLevelMenu. Throws if the run
+   // information is not of the event run or menu. Defined below.
+   void JoinRunInfo( const RunInfoBranches& );
+
+   // L1 algorithm and technical trigger bits, 64 per word. Only valid in the
+   // compact trigger form, or after UnpackTrigger() for either form.
+   bool L1Bit( const int i ) const { return ( L1Packed[i / 64] >> ( i % 64 ) ) & 1; }
+   bool TTBit( const int i ) const { return ( TTPacked[i / 64] >> ( i % 64 ) ) & 1; }
+
+   // Compact trigger encoding: the TrgBook states packed in 2 bits (16 per word)
+   // and the HLTbits in 1 bit (32 per word), L1 and TT in 1 bit (64 per word).
+   // Only one of the dense and packed forms is written, see compactTrigger in
+   // python/Ntuplizer_cfi.py.
+   void PackTrigger() {
+      nTrgBookPacked = ( nTrgBook + 15 ) / 16;
+      memset( TrgBookPacked, 0x00, sizeof( TrgBookPacked ) );
+      for( int i = 0; i < nTrgBook; ++i ){
+         TrgBookPacked[i / 16] |= bpk::PackTrgState( TrgBook[i] ) << ( 2 * ( i % 16 ) );
+      }
+
+      nHLTbitsPacked = ( nHLT + 31 ) / 32;
+      memset( HLTbitsPacked, 0x00, sizeof( HLTbitsPacked ) );
+      for( int i = 0; i < nHLT; ++i ){
+         if( HLTbits[i] ){ HLTbitsPacked[i / 32] |= 1u << ( i % 32 ); }
+      }
    }
 
-   void Register( TTree* root, const std::string& name = "VertexInfo" ) {
-      root->SetBranchAddress( ( name + ".Size" ).c_str() , &Size );
-      root->SetBranchAddress( ( name + ".isValid" ).c_str() , isValid );
-      root->SetBranchAddress( ( name + ".isFake" ).c_str() , isFake );
-      root->SetBranchAddress( ( name + ".Type" ).c_str() , Type );
-      root->SetBranchAddress( ( name + ".Ndof" ).c_str() , Ndof );
-      root->SetBranchAddress( ( name + ".NormalizedChi2" ).c_str() , NormalizedChi2 );
-      root->SetBranchAddress( ( name + ".Pt_Sum" ).c_str() , Pt_Sum );
-      root->SetBranchAddress( ( name + ".Pt_Sum2" ).c_str() , Pt_Sum2 );
-      root->SetBranchAddress( ( name + ".x" ).c_str() , x );
-      root->SetBranchAddress( ( name + ".y" ).c_str() , y );
-      root->SetBranchAddress( ( name + ".z" ).c_str() , z );
-      root->SetBranchAddress( ( name + ".Rho" ).c_str() , Rho );
+   // Rebuilding the dense TrgBook, HLTbits, L1 and TT after reading an entry of
+   // the tree the branches were registered to, with the same name. For files
+   // written in the dense form only the packed L1 and TT words are built, so
+   // L1Bit() and TTBit() can be used for both forms. If neither form of L1 or
+   // TT is in the tree, both are cleared.
+   void UnpackTrigger( TTree* tree, const std::string& name = "EvtInfo" ) {
+      if( nTrgBookPacked > 0 ){
+         nTrgBook = std::min( nTrgBookPacked * 16, N_TRIGGER_BOOKINGS );
+         for( int i = 0; i < nTrgBook; ++i ){
+            TrgBook[i] = bpk::UnpackTrgState( TrgBookPacked[i / 16] >> ( 2 * ( i % 16 ) ) );
+         }
+      }
+      if( nHLTbitsPacked > 0 ){
+         for( int i = 0; i < nHLT; ++i ){
+            HLTbits[i] = ( HLTbitsPacked[i / 32] >> ( i % 32 ) ) & 1u;
+         }
+      }
+      if( nL1Packed > 0 ){
+         for( int i = 0; i < 64 * N_L1_WORDS; ++i ){ L1[i] = L1Bit( i ); }
+      } else if( tree->GetBranch( ( name + ".L1" ).c_str() ) ){
+         memset( L1Packed, 0x00, sizeof( L1Packed ) );
+         for( int i = 0; i < 64 * N_L1_WORDS; ++i ){
+            if( L1[i] ){ L1Packed[i / 64] |= 1ull << ( i % 64 ); }
+         }
+      } else {
+         memset( L1, 0x00, sizeof( L1 ) );
+         memset( L1Packed, 0x00, sizeof( L1Packed ) );
+      }
+      if( nTTPacked > 0 ){
+         for( int i = 0; i < 64 * N_TT_WORDS; ++i ){ TT[i] = TTBit( i ); }
+      } else if( tree->GetBranch( ( name + ".TT" ).c_str() ) ){
+         memset( TTPacked, 0x00, sizeof( TTPacked ) );
+         for( int i = 0; i < 64 * N_TT_WORDS; ++i ){
+            if( TT[i] ){ TTPacked[i / 64] |= 1ull << ( i % 64 ); }
+         }
+      } else {
+         memset( TT, 0x00, sizeof( TT ) );
+         memset( TTPacked, 0x00, sizeof( TTPacked ) );
+      }
    }
 };
 
+#define BPK_GENINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   SCALAR( Int_t,   Size,                 I )                       \
+   SCALAR( Float_t, Weight,               F )                       \
+   VARRAY( Float_t, Pt,                   MAX_GENS, Size, F )       \
+   VARRAY( Float_t, Eta,                  MAX_GENS, Size, F )       \
+   VARRAY( Float_t, Phi,                  MAX_GENS, Size, F )       \
+   VARRAY( Float_t, Mass,                 MAX_GENS, Size, F )       \
+   VARRAY( Int_t,   PdgID,                MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   PhotonFlag,           MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Status,               MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   nMo,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   nDa,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo1,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo2,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Da1,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Da2,                  MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo1PdgID,             MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo2PdgID,             MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo1Status,            MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Mo2Status,            MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Da1PdgID,             MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   Da2PdgID,             MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   GrandMo1PdgID,        MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   GrandMo2PdgID,        MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   GrandMo1Status,       MAX_GENS, Size, I )       \
+   VARRAY( Int_t,   GrandMo2Status,       MAX_GENS, Size, I )       \
+   SCALAR( Float_t, LHENominalWeight,     F )                       \
+   SCALAR( Float_t, LHEOriginalWeight,    F )                       \
+   SCALAR( Int_t,   LHESize,              I )                       \
+   VARRAY( Int_t,   LHESystematicId,      MAX_LHE, LHESize, I )     \
+   VARRAY( Float_t, LHESystematicWeights, MAX_LHE, LHESize, F )     \
+   SCALAR( Int_t,   nLHEWeightRatio,      I )                       \
+   VARRAY( UShort_t, LHEWeightRatio,      MAX_LHE, nLHEWeightRatio, s )
+
+class GenInfoBranches {
+   BPK_BRANCH_CLASS( GenInfoBranches, BPK_GENINFO_FIELDS, "GenInfo" )
+
+public:
+   // Rebuilding LHESystematicWeights and LHESystematicId for files written with
+   // compactLHEWeights: the weights from the half precision ratios to the
+   // nominal weight, the IDs from the run information. Defined below.
+   void JoinRunInfo( const RunInfoBranches& );
+};
+
+#define BPK_JETINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING )                   \
+   SCALAR( Int_t,   Size,                                         I )                 \
+   VARRAY( Int_t,   Index,                                        MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   NTracks,                                      MAX_JETS, Size, I ) \
+   VARRAY( Float_t, Et,                                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Pt,                                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Eta,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Phi,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Px,                                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Py,                                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Pz,                                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Energy,                                       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Mass,                                         MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Area,                                         MAX_JETS, Size, F ) \
+   VARRAY( Int_t,   JetIDLOOSE,                                   MAX_JETS, Size, I ) \
+   VARRAY( Float_t, JetCharge,                                    MAX_JETS, Size, F ) \
+   VARRAY( Int_t,   NConstituents,                                MAX_JETS, Size, I ) \
+   VARRAY( Float_t, Pt_MuonCleaned,                               MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Eta_MuonCleaned,                              MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Phi_MuonCleaned,                              MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Energy_MuonCleaned,                           MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Unc,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, JesUnc,                                       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, JERPt,                                        MAX_JETS, Size, F ) \
+   VARRAY( Float_t, JERPhi,                                       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, JERScale,                                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtUncleaned,                                  MAX_JETS, Size, F ) \
+   VARRAY( Float_t, EtaUncleaned,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PhiUncleaned,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, EnergyUncleaned,                              MAX_JETS, Size, F ) \
+   VARRAY( Float_t, QGTagsLikelihood,                             MAX_JETS, Size, F ) \
+   VARRAY( Float_t, QGTagsAxis2,                                  MAX_JETS, Size, F ) \
+   VARRAY( Float_t, QGTagsMult,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, QGTagsPtD,                                    MAX_JETS, Size, F ) \
+   VARRAY( Int_t,   NCH,                                          MAX_JETS, Size, I ) \
+   VARRAY( Float_t, CEF,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, NHF,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, NEF,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, CHF,                                          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrRaw,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL2,                                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL3,                                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL7g,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL7uds,                                  MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL7c,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PtCorrL7b,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, combinedSecondaryVertexBJetTags,              MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfJetBProbabilityBJetTags,                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfJetProbabilityBJetTags,                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfTrackCountingHighPurBJetTags,               MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfTrackCountingHighEffBJetTags,               MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfSimpleSecondaryVertexHighEffBJetTags,       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfSimpleSecondaryVertexHighPurBJetTags,       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfCombinedSecondaryVertexV2BJetTags,          MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfCombinedInclusiveSecondaryVertexV2BJetTags, MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfCombinedSecondaryVertexSoftLeptonBJetTags,  MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfCombinedMVABJetTags,                        MAX_JETS, Size, F ) \
+   VARRAY( Float_t, pfBoostedDoubleSecondaryVertexAK8BJetTags,    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenJetPt,                                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenJetEta,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenJetPhi,                                    MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenPt,                                        MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenEta,                                       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, GenPhi,                                       MAX_JETS, Size, F ) \
+   VARRAY( Int_t,   GenPdgID,                                     MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   GenFlavor,                                    MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   GenHadronFlavor,                              MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   GenMCTag,                                     MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   NSubjets,                                     MAX_JETS, Size, I ) \
+   VARRAY( Int_t,   SubjetsIdxStart,                              MAX_JETS, Size, I ) \
+   VARRAY( Float_t, NjettinessAK8tau1,                            MAX_JETS, Size, F ) \
+   VARRAY( Float_t, NjettinessAK8tau2,                            MAX_JETS, Size, F ) \
+   VARRAY( Float_t, NjettinessAK8tau3,                            MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ak8PFJetsCHSSoftDropMass,                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ak8PFJetsCHSPrunedMass,                       MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ak8PFJetsCHSTrimmedMass,                      MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ak8PFJetsCHSFilteredMass,                     MAX_JETS, Size, F ) \
+   VARRAY( Float_t, topJetMass,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ca8TopMass,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, ca8MinMass,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Puppivtx3DSig,                                MAX_JETS, Size, F ) \
+   VARRAY( Float_t, Puppivtx3DVal,                                MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxMass,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxNtracks,                              MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPosX,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPosY,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPosZ,                                 MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPx,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPy,                                   MAX_JETS, Size, F ) \
+   VARRAY( Float_t, PuppivtxPz,                                   MAX_JETS, Size, F ) \
+   VECTOR( Float_t, SubjetMass )                                                      \
+   VECTOR( Float_t, SubjetPt )                                                        \
+   VECTOR( Float_t, SubjetEt )                                                        \
+   VECTOR( Float_t, SubjetEta )                                                       \
+   VECTOR( Float_t, SubjetPhi )                                                       \
+   VECTOR( Float_t, SubjetArea )                                                      \
+   VECTOR( Float_t, SubjetPtUncorr )                                                  \
+   VECTOR( Float_t, SubjetCombinedSVBJetTags )                                        \
+   VECTOR( Float_t, SubjetGenPdgId )                                                  \
+   VECTOR( Float_t, SubjetGenFlavour )                                                \
+   VECTOR( Float_t, SubjetHadronFlavour )                                             \
+   VARRAY( Float_t, JVAlpha,                                      MAX_JETS, Size, F ) \
+   VARRAY( Float_t, JVBeta,                                       MAX_JETS, Size, F )
+
+class JetInfoBranches {
+   BPK_BRANCH_CLASS( JetInfoBranches, BPK_JETINFO_FIELDS, "JetInfo" )
+};
+
+#define BPK_LEPINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING )         \
+   SCALAR( Int_t,   Size,                            I )                    \
+   VARRAY( Int_t,   Index,                           MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   LeptonType,                      MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   Charge,                          MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, Pt,                              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Et,                              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Eta,                             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Phi,                             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Px,                              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Py,                              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Pz,                              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Energy,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, TrackIso,                        MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, EcalIso,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, HcalIso,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ChargedHadronIso,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, NeutralHadronIso,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, PhotonIso,                       MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, SumPUPt,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ChargedHadronIsoR03,             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, NeutralHadronIsoR03,             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, PhotonIsoR03,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, sumPUPtR03,                      MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, IsoRhoCorrR03,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ChargedHadronIsoR04,             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, NeutralHadronIsoR04,             MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, PhotonIsoR04,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, sumPUPtR04,                      MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, IsoRhoCorrR04,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Ip3dPV,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Ip3dPVErr,                       MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Ip3dPVSignificance,              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MiniIso,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, CaloEnergy,                      MAX_LEPTONS, Size, F ) \
+   VARRAY( Bool_t,  isGoodMuonTMOneStationTight,     MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  isPFMuon,                        MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  MuIDGlobalMuonPromptTight,       MAX_LEPTONS, Size, O ) \
+   VARRAY( Float_t, MuGlobalNormalizedChi2,          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuCaloCompat,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   MuNChambers,                     MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNChambersMatchesSegment,       MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNMatchedStations,              MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNLostOuterHits,                MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNMuonhits,                     MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuDThits,                        MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuCSChits,                       MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuRPChits,                       MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuType,                          MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuontimenDof,                    MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, MuontimeAtIpInOut,               MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuontimeAtIpOutIn,               MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   Muondirection,                   MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, innerTracknormalizedChi2,        MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerPtError,                  MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuGlobalPtError,                 MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerTrackDz,                  MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerTrackD0,                  MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerTrackDxy_BS,              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerTrackDxy_PV,              MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, MuInnerTrackDxy_PVBS,            MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   MuInnerTrackNHits,               MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNTrackerHits,                  MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNLostInnerHits,                MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, vertexZ,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   MuNPixelLayers,                  MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNPixelLayersWMeasurement,      MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   MuNTrackLayersWMeasurement,      MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   ChargeGsf,                       MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   ChargeCtf,                       MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   ChargeScPix,                     MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   isEcalDriven,                    MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   isTrackerDriven,                 MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, caloEta,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, e1x5,                            MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, e2x5Max,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, e5x5,                            MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, HcalDepth1Iso,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, HcalDepth2Iso,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, EgammaMVANonTrig,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, EgammaMVATrig,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdTRIGGERTIGHT, MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdTRIGGERWP70,  MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdVETO,         MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdLOOSE,        MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdMEDIUM,       MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdTIGHT,        MAX_LEPTONS, Size, O ) \
+   VARRAY( Bool_t,  EgammaCutBasedEleIdHEEP,         MAX_LEPTONS, Size, O ) \
+   VARRAY( Float_t, Eldr03HcalDepth1TowerSumEtBc,    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Eldr03HcalDepth2TowerSumEtBc,    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Eldr04HcalDepth1TowerSumEtBc,    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Eldr04HcalDepth2TowerSumEtBc,    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElhcalOverEcalBc,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElEcalE,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElEoverP,                        MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, EldeltaEta,                      MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, EldeltaPhi,                      MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElHadoverEm,                     MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElsigmaIetaIeta,                 MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElscSigmaIetaIeta,               MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElEnergyErr,                     MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElMomentumErr,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElSharedHitsFraction,            MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, dR_gsf_ctfTrack,                 MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, dPt_gsf_ctfTrack,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Bool_t,  ElhasConv,                       MAX_LEPTONS, Size, O ) \
+   VARRAY( Int_t,   ElTrackNHits,                    MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, ElTrackNLostHits,                MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackDz,                       MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackDz_BS,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackD0,                       MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackDxy_BS,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackDxy_PV,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElTrackDxy_PVBS,                 MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   ElNClusters,                     MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   ElClassification,                MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, ElFBrem,                         MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   NumberOfExpectedInnerHits,       MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, Eldist,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Eldcot,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, Elconvradius,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElConvPoint_x,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElConvPoint_y,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElConvPoint_z,                   MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, dcotdist,                        MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElseedEoverP,                    MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElEcalIso04,                     MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, ElHcalIso04,                     MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   ElNumberOfBrems,                 MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, TrgPt,                           MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, TrgEta,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, TrgPhi,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   TrgID,                           MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   isPFTau,                         MAX_LEPTONS, Size, I ) \
+   VARRAY( Float_t, GenPt,                           MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, GenEta,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Float_t, GenPhi,                          MAX_LEPTONS, Size, F ) \
+   VARRAY( Int_t,   GenPdgID,                        MAX_LEPTONS, Size, I ) \
+   VARRAY( Int_t,   GenMCTag,                        MAX_LEPTONS, Size, I )
+
+class LepInfoBranches {
+   BPK_BRANCH_CLASS( LepInfoBranches, BPK_LEPINFO_FIELDS, "LepInfo" )
+};
+
+#define BPK_PHOTONINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   SCALAR( Int_t,   Size,                 I )                          \
+   VARRAY( Float_t, Pt,                   MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, Eta,                  MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, Phi,                  MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, HoverE,               MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, SigmaIetaIeta,        MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, hadTowOverEm,         MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, hcalIsoConeDR04_2012, MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, phoPFChIso,           MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, phoPFNeuIso,          MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, phoPFPhoIso,          MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, sigmaIetaIeta,        MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, isoChEffArea,         MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, isoNeuEffArea,        MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, isoPhoEffArea,        MAX_PHOTONS, Size, F )       \
+   VARRAY( Bool_t,  phoPassLoose,         MAX_PHOTONS, Size, O )       \
+   VARRAY( Bool_t,  phoPassMedium,        MAX_PHOTONS, Size, O )       \
+   VARRAY( Bool_t,  phoPassTight,         MAX_PHOTONS, Size, O )       \
+   VARRAY( Float_t, r9,                   MAX_PHOTONS, Size, F )       \
+   VARRAY( Bool_t,  passelectronveto,     MAX_PHOTONS, Size, O )       \
+   VARRAY( Bool_t,  hasPixelSeed,         MAX_PHOTONS, Size, O )       \
+   VARRAY( Float_t, EcalIso,              MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, HcalIso,              MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, TrackIso,             MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, GenPt,                MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, GenEta,               MAX_PHOTONS, Size, F )       \
+   VARRAY( Float_t, GenPhi,               MAX_PHOTONS, Size, F )       \
+   VARRAY( Int_t,   GenPdgID,             MAX_PHOTONS, Size, I )
+
+class PhotonInfoBranches {
+   BPK_BRANCH_CLASS( PhotonInfoBranches, BPK_PHOTONINFO_FIELDS, "PhotonInfo" )
+};
+
+#define BPK_TRGINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   SCALAR( Int_t,   Size,        I )                                \
+   VARRAY( Int_t,   TriggerBit,  MAX_TRGOBJS, Size, I )             \
+   VARRAY( Int_t,   FilterLabel, MAX_TRGOBJS, Size, I )             \
+   VARRAY( Float_t, Pt,          MAX_TRGOBJS, Size, F )             \
+   VARRAY( Float_t, Eta,         MAX_TRGOBJS, Size, F )             \
+   VARRAY( Float_t, Phi,         MAX_TRGOBJS, Size, F )             \
+   VARRAY( Float_t, Energy,      MAX_TRGOBJS, Size, F )
+
+class TrgInfoBranches {
+   BPK_BRANCH_CLASS( TrgInfoBranches, BPK_TRGINFO_FIELDS, "TrgInfo" )
+};
+
+#define BPK_VERTEXINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   SCALAR( Int_t,   Size,           I )                                \
+   VARRAY( Int_t,   isValid,        MAX_Vertices, Size, I )            \
+   VARRAY( Bool_t,  isFake,         MAX_Vertices, Size, O )            \
+   VARRAY( Int_t,   Type,           MAX_Vertices, Size, I )            \
+   VARRAY( Float_t, Ndof,           MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, NormalizedChi2, MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, Pt_Sum,         MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, Pt_Sum2,        MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, x,              MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, y,              MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, z,              MAX_Vertices, Size, F )            \
+   VARRAY( Float_t, Rho,            MAX_Vertices, Size, F )
+
+class VertexInfoBranches {
+   BPK_BRANCH_CLASS( VertexInfoBranches, BPK_VERTEXINFO_FIELDS, "VertexInfo" )
+};
+
+#define BPK_RUNINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING )                   \
+   SCALAR( Int_t,       PdfID,              I )                                         \
+   SCALAR( Int_t,       RunNo,              I )                                         \
+   SCALAR( Int_t,       nHLT,               I )                                         \
+   VECTOR( std::string, HLTName )                                                       \
+   VARRAY( Int_t,       HLTName2enum,       MAX_HLTPATHS, nHLT, I )                     \
+   SCALAR( Int_t,       nHLTPrescaleColumn, I )                                         \
+   SCALAR( Int_t,       nHLTPrescale,       I )                                         \
+   VARRAY( Int_t,       HLTPrescaleTable,   MAX_HLTPRESCALES, nHLTPrescale, I )       \
+   SCALAR( Int_t,       nLHEWeight,         I )                                         \
+   VARRAY( Int_t,       LHEWeightId,        MAX_LHE, nLHEWeight, I )                    \
+   VARRAY( Int_t,       LHEWeightGroup,     MAX_LHE, nLHEWeight, I )                    \
+   VECTOR( std::string, LHEWeightGroupName )                                            \
+   SCALAR( ULong64_t,   Events,             l )                                         \
+   SCALAR( Double_t,    SumWeight,          D )                                         \
+   SCALAR( Double_t,    SumWeight2,         D )                                         \
+   SCALAR( Int_t,       nSumLHEWeight,      I )                                         \
+   VARRAY( Double_t,    SumLHEWeight,       MAX_LHE, nSumLHEWeight, D )
+
 class RunInfoBranches {
+   BPK_BRANCH_CLASS( RunInfoBranches, BPK_RUNINFO_FIELDS, "RunInfo" )
+
 public:
-   Int_t PdfID;
+   // HLT menu of the run: the path names and TriggerBooking indices in menu
+   // order, and the prescales of every path for every prescale column.
+   // LHE weights of the run: the IDs in the order of the event weights, and
+   // the index of their weight group in LHEWeightGroupName (-1 if none).
+   // Weight counts of all the processed events of the run, see LumiInfoBranches.
+   // The prescale is -1 for columns not stored, see MAX_HLTPRESCALES.
+   int HLTPrescale( const int column, const int path ) const {
+      return column >= 0 && column < nHLTPrescaleColumn ? HLTPrescaleTable[column * nHLT + path] : -1;
+   }
+};
 
-   void RegisterTree( TTree* root, const std::string& name = "RunInfo" ) {
-      root->Branch( ( name + ".PdfID" ).c_str(), &PdfID, ( name + "PdfID/I" ).c_str() );
+inline void
+EvtInfoBranches::JoinRunInfo( const RunInfoBranches& runinfo ) {
+   if( runinfo.RunNo != RunNo || runinfo.nHLT != nHLT ){
+      throw std::runtime_error( "EvtInfo.JoinRunInfo: run " + std::to_string( runinfo.RunNo ) + " with "
+                                + std::to_string( runinfo.nHLT ) + " paths loaded for an event of run "
+                                + std::to_string( RunNo ) + " with " + std::to_string( nHLT ) + " paths" );
    }
+   for( int i = 0; i < nHLT; ++i ){
+      HLTName2enum[i]      = runinfo.HLTName2enum[i];
+      HLTPrescaleFactor[i] = runinfo.HLTPrescale( HLTPrescaleColumn, i );
+   }
+}
 
-   void Register( TTree* root, const std::string& name = "RunInfo" ) {
-      root->SetBranchAddress( ( name + ".PdfID" ).c_str() , &PdfID );
+inline void
+GenInfoBranches::JoinRunInfo( const RunInfoBranches& runinfo ) {
+   if( nLHEWeightRatio <= 0 ){ return; }
+   LHESize = nLHEWeightRatio;
+   for( int i = 0; i < LHESize; ++i ){
+      LHESystematicWeights[i] = LHENominalWeight * bpk::HalfToFloat( LHEWeightRatio[i] );
+      LHESystematicId[i]      = i < runinfo.nLHEWeight ? runinfo.LHEWeightId[i] : -1;
    }
+}
+
+namespace bpk {
+
+// Reading the run tree entries by run number, for joining the run level
+// information to the events:
+//    bpk::RunInfoReader runreader( (TTree*)file->Get( "bprimeKit/run" ) );
+//    ... if( runreader.Load( EvtInfo.RunNo ) ){ EvtInfo.JoinRunInfo( runreader.RunInfo ); }
+//        (likewise GenInfo.JoinRunInfo( runreader.RunInfo ) for the LHE weights)
+class RunInfoReader {
+public:
+   explicit RunInfoReader( TTree* runtree ) : _tree( runtree ), _entry( -1 ) {
+      RunInfo.Register( _tree );
+      for( Long64_t i = 0; i < _tree->GetEntries(); ++i ){
+         _tree->GetEntry( i );
+         _entrylist.emplace_back( RunInfo.RunNo, i );// First entry of every run is used
+      }
+      std::stable_sort( _entrylist.begin(), _entrylist.end(),
+                        []( const std::pair<Int_t, Long64_t>& x, const std::pair<Int_t, Long64_t>& y ){ return x.first < y.first; } );
+   }
+
+   // Loading the entry of the run, only reading the tree if the run changed.
+   // False if the run is not in the tree.
+   bool Load( const Int_t run ) {
+      if( _entry >= 0 && RunInfo.RunNo == run ){ return true; }
+      const auto found = std::lower_bound( _entrylist.begin(), _entrylist.end(), std::make_pair( run, (Long64_t)-1 ) );
+      if( found == _entrylist.end() || found->first != run ){ return false; }
+      _entry = found->second;
+      _tree->GetEntry( _entry );
+      return true;
+   }
+
+   RunInfoBranches RunInfo;
+
+private:
+   TTree* _tree;
+   Long64_t _entry;
+   std::vector<std::pair<Int_t, Long64_t> > _entrylist;
+};
+
+}
+
+// Counts of all the processed events of a luminosity block, before any skim
+// selection: number of events, sum of the generator weights and of their
+// squares, and sum of every LHE systematic weight (MC only).
+#define BPK_LUMIINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   SCALAR( Int_t,     RunNo,         I )                             \
+   SCALAR( Int_t,     LumiNo,        I )                             \
+   SCALAR( ULong64_t, Events,        l )                             \
+   SCALAR( Double_t,  SumWeight,     D )                             \
+   SCALAR( Double_t,  SumWeight2,    D )                             \
+   SCALAR( Int_t,     nSumLHEWeight, I )                             \
+   VARRAY( Double_t,  SumLHEWeight,  MAX_LHE, nSumLHEWeight, D )
+
+class LumiInfoBranches {
+   BPK_BRANCH_CLASS( LumiInfoBranches, BPK_LUMIINFO_FIELDS, "LumiInfo" )
+};
+
+namespace bpk {
+
+// Adding the weight counts of a LumiInfoBranches/RunInfoBranches to another
+template<typename Target, typename Source>
+inline void AddWeightCounts( Target& x, const Source& y ) {
+   x.Events     += y.Events;
+   x.SumWeight  += y.SumWeight;
+   x.SumWeight2 += y.SumWeight2;
+   x.nSumLHEWeight = std::max( x.nSumLHEWeight, y.nSumLHEWeight );
+   for( int i = 0; i < y.nSumLHEWeight; ++i ){
+      x.SumLHEWeight[i] += y.SumLHEWeight[i];
+   }
+}
+
+}
+
+#define BPK_PERFINFO_FIELDS( SCALAR, ARRAY, VARRAY, VECTOR, STRING ) \
+   STRING( Char_t,    Name,            64 )                          \
+   SCALAR( ULong64_t, Calls,           l )                           \
+   SCALAR( Double_t,  WallTime,        D )                           \
+   SCALAR( Double_t,  CpuTime,         D )                           \
+   SCALAR( Double_t,  RegisterTime,    D )                           \
+   SCALAR( Double_t,  RegisterCpuTime, D )                           \
+   SCALAR( ULong64_t, ObjSeen,         l )                           \
+   SCALAR( ULong64_t, ObjStored,       l )                           \
+   SCALAR( ULong64_t, EvtSeen,         l )                           \
+   SCALAR( ULong64_t, EvtStored,       l )
+
+class PerfInfoBranches {
+   BPK_BRANCH_CLASS( PerfInfoBranches, BPK_PERFINFO_FIELDS, "PerfInfo" )
 };
 
 
@@ -15,9 +15,9 @@
 #include "bpkFrameWork/bprimeKit/interface/TriggerNtuplizer.hpp"
 #include "bpkFrameWork/bprimeKit/interface/VertexNtuplizer.hpp"
 
-#include <TFile.h>
 #include <TTree.h>
 #include <iostream>
+#include <tbb/task_group.h>
 
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "FWCore/Framework/interface/MakerMacros.h"// For plugin definition
@@ -30,105 +30,215 @@ using namespace std;
 *   Constructor and destructor
 *******************************************************************************/
 
-bprimeKit::bprimeKit( const edm::ParameterSet& iConfig ):
-  _lheruntoken( consumes<LHERunInfoProduct, edm::InRun>( iConfig.getParameter<edm::InputTag>( "lherunsrc" ) ) ) 
+bprimeKit::bprimeKit( const edm::ParameterSet& iConfig, const NtupleWriter* writer ):
+  _currentset( 0 ),
+  _parallelntuplizers( iConfig.getUntrackedParameter<bool>( "parallelNtuplizers", false ) ),
+  _lheruntoken( consumes<LHERunInfoProduct, edm::InRun>( iConfig.getParameter<edm::InputTag>( "lherunsrc" ) ) )
 {
+  // Double buffering the branches if the output is written asynchronously
+  const unsigned nset = writer->IsAsync() ? 2 : 1;
+
+  for( unsigned i = 0; i < nset; ++i ){
+    MakeNtuplizerSet( iConfig );
+  }
+}
+
+/******************************************************************************/
+
+bprimeKit::~bprimeKit()
+{
+  for( auto& set : _ntuplizerset ){
+    if( set.pending.valid() ){ set.pending.wait(); }
+
+    for( auto ntuplizer : set.ntuplizerlist ){
+      delete ntuplizer;
+    }
+
+    delete set.skimmer;
+    delete set.streamtree;
+  }
+}
+
+/******************************************************************************/
+
+void
+bprimeKit::MakeNtuplizerSet( const edm::ParameterSet& iConfig )
+{
+  _ntuplizerset.emplace_back();
+  std::vector<NtuplizerBase*>& ntuplizerlist = _ntuplizerset.back().ntuplizerlist;
+
   // Event and Gen settings
   const auto& evtgensetting = iConfig.getParameter<edm::ParameterSet>( "evtgensetting" );
-  _ntuplizerlist.push_back( new EvtGenNtuplizer( evtgensetting, this ) );
+  ntuplizerlist.push_back( new EvtGenNtuplizer( evtgensetting, this ) );
 
   // Trigger object settings
   const auto& triggersetting = iConfig.getParameter<edm::ParameterSet>( "triggersetting" );
-  _ntuplizerlist.push_back( new TriggerNtuplizer( triggersetting, this ) );
+  ntuplizerlist.push_back( new TriggerNtuplizer( triggersetting, this ) );
 
   // Vertex settings
   const auto& vtxsetting = iConfig.getParameter<edm::ParameterSet>( "vtxsetting" );
-  _ntuplizerlist.push_back( new VertexNtuplizer( vtxsetting, this ) );
+  ntuplizerlist.push_back( new VertexNtuplizer( vtxsetting, this ) );
 
   // Electron settings
   for( const auto& lepparam : iConfig.getParameter<edm::VParameterSet>( "leptonsettings" ) ){
-    _ntuplizerlist.push_back( new LeptonNtuplizer( lepparam, this ) );
+    ntuplizerlist.push_back( new LeptonNtuplizer( lepparam, this ) );
   }
 
   // Photon settings
   for( const auto& photonparam : iConfig.getParameter<edm::VParameterSet>( "photonsettings" ) ){
-    _ntuplizerlist.push_back( new PhotonNtuplizer( photonparam, this ) );
+    ntuplizerlist.push_back( new PhotonNtuplizer( photonparam, this ) );
   }
 
   // Jet settings
   for( const auto& jetparam : iConfig.getParameter<edm::VParameterSet>( "jetsettings" ) ){
-    _ntuplizerlist.push_back( new JetNtuplizer( jetparam, this ) );
+    ntuplizerlist.push_back( new JetNtuplizer( jetparam, this ) );
   }
 
-  _hltmap.clear();
+  // Stream tree for holding the branch addresses, never attached to a file
+  TTree* streamtree = new TTree( "root", "root" );
+  streamtree->SetDirectory( nullptr );
 
-  for( int i = 0; i < N_TRIGGER_BOOKINGS; i++ ){
-    _hltmap.insert( pair<std::string, int>( TriggerBooking[i], i ) );
+  for( auto ntuplizer : ntuplizerlist ){
+    ntuplizer->TimedRegisterTree( streamtree );
   }
 
-  /***** MADITORY!! DO NOT REMOVE  *********************************************/
-  edm::Service<TFileService> fs;
-  TFileDirectory subDir = fs->mkdir( "mySubDirectory" );
-  /******************************************************************************/
+  _ntuplizerset.back().streamtree = streamtree;
+  _ntuplizerset.back().skimmer    = new EventSkimmer( iConfig.getParameter<edm::ParameterSet>( "skimsetting" ), streamtree );
+}
+
+
+/*******************************************************************************
+*   Global transitions
+*******************************************************************************/
+std::unique_ptr<NtupleWriter>
+bprimeKit::initializeGlobalCache( const edm::ParameterSet& iConfig )
+{
+  return std::unique_ptr<NtupleWriter>( new NtupleWriter( iConfig ) );
 }
 
 /******************************************************************************/
 
-bprimeKit::~bprimeKit()
+void
+bprimeKit::globalBeginJob( NtupleWriter* writer )
 {
-  for( auto ntuplizer : _ntuplizerlist ){
-    delete ntuplizer;
-  }
+  writer->BeginJob();
 }
 
+/******************************************************************************/
 
-/*******************************************************************************
-*
-*  Note :
-*    1. All writing objects (TTrees, TH1Fs) MUST be created here and
-*       not in the analyzer constructor!!
-*    2. Do not use the WRITE functions and delete operator!! These are
-*       automatically handled by the TFileService instance.
-*
-*******************************************************************************/
 void
-bprimeKit::beginJob()
+bprimeKit::globalEndJob( NtupleWriter* writer )
 {
-  BaseTree = new TTree( "root", "root" );
-  RunTree  = new TTree( "run", "run"  );
+  /***** DO NOT DELETE TREES!  **************************************************/
+  writer->EndJob();
+}
 
-  for( auto ntuplizer : _ntuplizerlist ){
-    ntuplizer->RegisterTree( BaseTree );
-  }
+/******************************************************************************/
 
-  RunInfo.RegisterTree( RunTree );
+std::shared_ptr<RunInfoBranches>
+bprimeKit::globalBeginRunSummary( const edm::Run&, const edm::EventSetup&, const RunContext* )
+{
+  return std::make_shared<RunInfoBranches>();
 }
 
 /******************************************************************************/
 
 void
-bprimeKit::endJob()
+bprimeKit::globalEndRunSummary( const edm::Run& iRun, const edm::EventSetup&, const RunContext* context, RunInfoBranches* runinfo )
 {
-  /***** DO NOT DELETE TREES!  **************************************************/
+  context->global()->FillRun( iRun.run(), *runinfo );
+}
+
+/******************************************************************************/
+
+std::shared_ptr<LumiInfoBranches>
+bprimeKit::globalBeginLuminosityBlockSummary( const edm::LuminosityBlock& iLumi, const edm::EventSetup&, const LuminosityBlockContext* )
+{
+  auto lumiinfo    = std::make_shared<LumiInfoBranches>();
+  lumiinfo->RunNo  = iLumi.run();
+  lumiinfo->LumiNo = iLumi.luminosityBlock();
+  return lumiinfo;
+}
+
+/******************************************************************************/
+
+void
+bprimeKit::globalEndLuminosityBlockSummary( const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext* context, LumiInfoBranches* lumiinfo )
+{
+  context->global()->FillLumi( *lumiinfo );
 }
 
 
 /*******************************************************************************
-*   Event based analysis methods
+*   Stream based analysis methods
 *******************************************************************************/
+void
+bprimeKit::beginStream( edm::StreamID )
+{
+  globalCache()->Book( _ntuplizerset.front().streamtree );
+}
+
+/******************************************************************************/
+
+void
+bprimeKit::endStream()
+{
+  for( auto& set : _ntuplizerset ){
+    // Buffers must stay valid until the last asynchronous fill is done
+    if( set.pending.valid() ){ set.pending.get(); }
+
+    std::vector<NtuplizerStats> statlist;
+
+    for( const auto ntuplizer : set.ntuplizerlist ){
+      statlist.push_back( ntuplizer->Stats() );
+    }
+
+    statlist.push_back( set.skimmer->Stats() );
+
+    globalCache()->MergeStats( statlist );
+  }
+}
+
+/******************************************************************************/
+
 void
 bprimeKit::beginRun( const edm::Run& iRun, const edm::EventSetup& iSetup )
 {
+  // Only the run level caches of the ntuplizers are updated, not the branch
+  // buffers, so this is safe while an asynchronous fill is in progress
+  for( auto& set : _ntuplizerset ){
+    for( auto ntuplizer : set.ntuplizerlist ){
+      ntuplizer->BeginRun( iRun, iSetup );
+    }
+  }
+}
+
+/******************************************************************************/
+
+void
+bprimeKit::endRunSummary( const edm::Run& iRun, const edm::EventSetup& iSetup, RunInfoBranches* runinfo ) const
+{
+  // Calls are serialized across streams by the framework, the bprimeKit run
+  // info is only filled by the first stream
+  FillRunInfo( iRun, *runinfo );
+
+  // The run level caches are identical in all the ntuplizer sets
+  for( auto ntuplizer : _ntuplizerset.front().ntuplizerlist ){
+    ntuplizer->FillRunInfo( iRun, *runinfo );
+  }
 }
 
 /******************************************************************************/
 
 void
-bprimeKit::endRun( const edm::Run& iRun, const edm::EventSetup& iSetup )
+bprimeKit::endLuminosityBlockSummary( const edm::LuminosityBlock& iLumi, const edm::EventSetup&, LumiInfoBranches* lumiinfo ) const
 {
-  GetRunObjects( iRun, iSetup );
-  FillRunInfo();
-  RunTree->Fill();
+  // Both ntuplizer sets process events of the luminosity block
+  for( const auto& set : _ntuplizerset ){
+    for( auto ntuplizer : set.ntuplizerlist ){
+      ntuplizer->FillLumiInfo( iLumi, *lumiinfo );
+    }
+  }
 }
 
 /******************************************************************************/
@@ -136,11 +246,42 @@ bprimeKit::endRun( const edm::Run& iRun, const edm::EventSetup& iSetup )
 void
 bprimeKit::analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
-  for( auto ntuplizer : _ntuplizerlist ){
-    ntuplizer->Analyze( iEvent, iSetup );
+  NtuplizerSet& set = _ntuplizerset[_currentset];
+  _currentset = ( _currentset + 1 ) % _ntuplizerset.size();
+
+  // Waiting for the previous fill from these buffers, rethrowing its errors
+  if( set.pending.valid() ){ set.pending.get(); }
+
+  // All the products are read here, in turn: the event is not accessed
+  // concurrently, and unscheduled producers are run before the tasks start.
+  for( auto ntuplizer : set.ntuplizerlist ){
+    ntuplizer->TimedGetHandles( iEvent, iSetup );
   }
 
-  BaseTree->Fill();
+  if( _parallelntuplizers ){
+    // Every ntuplizer only writes to its own branch buffers and reads the
+    // products from its handles, so they can be run as independent tasks.
+    // wait() acts as the barrier before filling and rethrows any exception
+    // raised inside a task.
+    tbb::task_group group;
+
+    for( auto ntuplizer : set.ntuplizerlist ){
+      group.run( [ntuplizer, &iEvent, &iSetup](){
+        ntuplizer->TimedAnalyze( iEvent, iSetup );
+      } );
+    }
+
+    group.wait();
+  } else {
+    for( auto ntuplizer : set.ntuplizerlist ){
+      ntuplizer->TimedAnalyze( iEvent, iSetup );
+    }
+  }
+
+  // Events failing the skim selection are not written
+  if( set.skimmer->Pass() ){
+    set.pending = globalCache()->Fill( set.streamtree, iEvent.id() );
+  }
 }
 
 
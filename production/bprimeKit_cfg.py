@@ -27,6 +27,8 @@ process.source = cms.Source("PoolSource",
 process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.maxEvents) )
 process.options = cms.untracked.PSet( wantSummary = cms.untracked.bool(options.wantSummary) )
 process.options.allowUnscheduled = cms.untracked.bool(True) ## Run all processes regardless of definition
+process.options.numberOfThreads  = cms.untracked.uint32(options.NumThreads)
+process.options.numberOfStreams  = cms.untracked.uint32(0) ## One stream per thread
 
 process.load("FWCore.MessageService.MessageLogger_cfi")
 process.MessageLogger.categories.append('HLTrigReport')
@@ -95,6 +97,10 @@ process.TFileService = cms.Service("TFileService",
 
 # See the file python/bprimeKit_* default settings for the various DataProcessings
 process.bprimeKit = mysetting.bprimeKit
+process.bprimeKit.parallelNtuplizers = cms.untracked.bool(options.ParallelNtuplizers)
+if options.AsyncOutput:
+   ## The writer thread comes on top of NumThreads
+   process.bprimeKit.outputsetting.asyncFill = cms.bool(True)
 
 #-------------------------------------------------------------------------------
 #   Final output settings
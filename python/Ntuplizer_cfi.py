@@ -17,11 +17,20 @@ beamspotsrc = cms.InputTag( 'offlineBeamSpot' )
 hltsrc      = cms.InputTag( 'TriggerResults::HLT' )
 gensrc      = cms.InputTag( 'prunedGenParticles' )
 
+#-------------------------------------------------------------------------------
+#   Every ntuplizer PSet takes keepBranches/dropBranches glob lists, matched
+#   against the field name ( 'PtCorrL7*' ) or the full branch name
+#   ( 'EvtInfo.L1' ). An empty keep list keeps everything, dropped branches are
+#   never booked. Ex:
+#       ak4jet.dropBranches = cms.vstring( 'PtCorrL7*' )
+#-------------------------------------------------------------------------------
 
 #-------------------------------------------------------------------------------
 #   EvtGen settings
 #-------------------------------------------------------------------------------
 evtgenbase = cms.PSet(
+    keepBranches  = cms.vstring(),
+    dropBranches  = cms.vstring(),
     rhosrc        = rhosrc,
     metsrc        = cms.InputTag('slimmedMETsMuEGClean'),
     puppimetsrc   = cms.InputTag('slimmedMETs'),
@@ -31,17 +40,48 @@ evtgenbase = cms.PSet(
     genevtsrc     = cms.InputTag('generator'),
     gensrc        = gensrc,
     gtdigisrc     = cms.InputTag('gtDigis'),
+    l1algsrc      = cms.InputTag('gtStage2Digis'),
     lhesrc        = cms.InputTag('externalLHEProducer'),
     metbadchadsrc = cms.InputTag("BadChargedCandidateFilter"),
     metbadmusrc   = cms.InputTag("BadPFMuonFilter"),
-    mettriggersrc = cms.InputTag("TriggerResults","","RECO")
-
+    mettriggersrc = cms.InputTag("TriggerResults","","RECO"),
+    ## Store TrgBook/HLTbits/L1/TT packed in TrgBookPacked/HLTbitsPacked (2/1
+    ## bits per path) and L1Packed/TTPacked (64 bits per word), readers rebuild
+    ## the dense arrays with EvtInfo.UnpackTrigger(tree)
+    compactTrigger = cms.bool(False),
+    ## Store the trigger states per versionless path family in TrgFamily
+    ## instead of TrgBook, indexed by bpk::TriggerFamilyList(), the version is
+    ## resolved per menu
+    familyTrigger  = cms.bool(False),
+    ## Store the HLT path names, TriggerBooking indices and prescale tables once
+    ## per run in the run tree, events only keep HLTPrescaleColumn
+    runLevelMenu   = cms.bool(False),
+    ## Store the LHE weights as half precision ratios to the nominal weight in
+    ## LHEWeightRatio, the weight IDs and groups once per run in the run tree.
+    ## Readers rebuild the weights with GenInfo.JoinRunInfo()
+    compactLHEWeights = cms.bool(False),
+    ## Stored gen particles: a particle is selected if it passes all the
+    ## criteria, empty lists accept everything. With keepAncestors all mothers
+    ## of the selected particles are stored as well. At most maxSize ( up to
+    ## MAX_GENS ) particles are stored in collection order, the Mo/Da indices
+    ## refer to the stored particles ( -1 if not stored ). The EvtInfo Mc*
+    ## decay modes and the ljmet tags use all particles, whatever the selection
+    genSelection   = cms.PSet(
+        maxSize       = cms.int32(60),
+        status        = cms.vint32(),
+        pdgIds        = cms.vint32(), ## absolute values
+        lastCopy      = cms.bool(False),
+        hardProcess   = cms.bool(False),
+        keepAncestors = cms.bool(False),
+        ),
     )
 
 #-------------------------------------------------------------------------------
 #   Vertex settings
 #-------------------------------------------------------------------------------
 vertexbase = cms.PSet(
+    keepBranches = cms.vstring(),
+    dropBranches = cms.vstring(),
     vtxsrc = vtxsrc,
     vtxBSsrc = vtxBSsrc,
 )
@@ -50,6 +90,8 @@ vertexbase = cms.PSet(
 #   Trigger object settings
 #-------------------------------------------------------------------------------
 triggerbase = cms.PSet(
+    keepBranches  = cms.vstring(),
+    dropBranches  = cms.vstring(),
     triggersrc    = hltsrc,
     triggerobjsrc = cms.InputTag( 'selectedPatTrigger'),
     triggerlist   = cms.VPSet(
@@ -96,6 +138,8 @@ triggerbase = cms.PSet(
 #   Photon settings
 #-------------------------------------------------------------------------------
 photonbase = cms.PSet(
+    keepBranches   = cms.vstring(),
+    dropBranches   = cms.vstring(),
     photonname = cms.string('PhotonInfo'),
     photonsrc  = cms.InputTag('slimmedPhotons'),
     rhosrc     = rhosrc,
@@ -116,6 +160,8 @@ photonbase = cms.PSet(
 #   Lepton settings
 #-------------------------------------------------------------------------------
 leptonbase = cms.PSet(
+    keepBranches   = cms.vstring(),
+    dropBranches   = cms.vstring(),
     leptonname     = cms.string('LepInfo'),
     muonsrc        = cms.InputTag('slimmedMuons'),
     elecsrc        = cms.InputTag('slimmedElectrons'),
@@ -138,6 +184,8 @@ leptonbase = cms.PSet(
 #   Jet settings
 #-------------------------------------------------------------------------------
 jetcommon = cms.PSet(
+    keepBranches=cms.vstring(),
+    dropBranches=cms.vstring(),
     jetname=cms.string('JetInfo'),
     jettype=cms.string(''),
     muonsrc=cms.InputTag('slimmedMuons'),
@@ -169,3 +217,65 @@ ca8jetbase.jetname   = cms.string('JetCA8Info')
 ca8jetbase.jettype   = cms.string('AK8PFchs')
 ca8jetbase.jetsrc    = cms.InputTag('selectedPatJetsAK8PFCHS')
 ca8jetbase.subjetsrc = cms.InputTag('patJetsCMSTopTagCHSPacked')
+
+#-------------------------------------------------------------------------------
+#   Output file settings
+#     compressionAlgorithm : ZLIB, LZMA, LZ4 or ZSTD (LZ4/ZSTD need ROOT >= 6.10/6.20)
+#     autoFlush            : TTree::SetAutoFlush, > 0 entries per cluster,
+#                            < 0 bytes per cluster
+#     basketSizes          : basket size per branch group, later entries take
+#                            precedence, ex.
+#                            cms.PSet( branches=cms.string('JetInfo.*'), size=cms.int32(256000) )
+#     asyncFill            : write the output tree from a dedicated thread,
+#                            double buffering the branches of each stream.
+#                            The thread comes on top of numberOfThreads.
+#     rollover*            : write the root and run trees to numbered files
+#                            <TFileService name>_<N>.root instead, starting a
+#                            new file once the written size (MB) or the number
+#                            of events is reached, or at every new luminosity
+#                            block. 0/False disables a limit. Each file has its
+#                            own run tree, holding all runs of its events.
+#-------------------------------------------------------------------------------
+outputbase = cms.PSet(
+    compressionAlgorithm = cms.string('ZLIB'),
+    compressionLevel     = cms.int32(1),
+    autoFlush            = cms.int64(-30000000),
+    basketSizes          = cms.VPSet(),
+    asyncFill            = cms.bool(False),
+    rolloverSizeMB       = cms.int64(0),
+    rolloverEvents       = cms.int64(0),
+    rolloverLumi         = cms.bool(False),
+)
+
+#-------------------------------------------------------------------------------
+#   Event skim settings, events failing any of the selections are not written
+#     leptons  : minimum number of leptons of a collection passing the pt/|eta|
+#                cuts, leptonType 11/13/15 counts a single flavour, 0 all
+#     jets     : minimum number of jets and scalar pt sum (HT) of the jets of a
+#                collection passing the pt/|eta| cuts
+#     triggers : at least one of the matching booked paths fired (EvtInfo.TrgBook,
+#                or the families of the paths with familyTrigger), wildcards
+#                allowed, ex. 'HLT_Ele27_WPTight_Gsf_v*'
+#   The selected branches must not be removed with dropBranches.
+#-------------------------------------------------------------------------------
+skimbase = cms.PSet(
+    leptons  = cms.VPSet(),
+    jets     = cms.VPSet(),
+    triggers = cms.vstring(),
+)
+
+leptonskim = cms.PSet(
+    collection = cms.string('LepInfo'),
+    leptonType = cms.int32(0),
+    minPt      = cms.double(30),
+    maxAbsEta  = cms.double(2.4),
+    minCount   = cms.int32(1),
+)
+
+jetskim = cms.PSet(
+    collection = cms.string('JetInfo'),
+    minPt      = cms.double(30),
+    maxAbsEta  = cms.double(2.4),
+    minCount   = cms.int32(0),
+    minHT      = cms.double(0),
+)
@@ -35,6 +35,9 @@ bprimeKit = cms.EDAnalyzer(
 
     lherunsrc=cms.InputTag('externalLHEProducer'),
 
+    outputsetting  = ntpl.outputbase,
+    skimsetting    = ntpl.skimbase,
+
     evtgensetting  = ntpl.evtgenbase,
     vtxsetting     = ntpl.vertexbase,
     triggersetting = ntpl.triggerbase,
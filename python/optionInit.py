@@ -86,4 +86,25 @@ def initBPKOptions( options ):
         'Whether to use the jet tool kit to recluster jets'
     )
 
+   options.register('NumThreads',
+        1,
+        opts.VarParsing.multiplicity.singleton,
+        opts.VarParsing.varType.int,
+        'Number of threads (and streams) for the cmsRun job'
+    )
+
+   options.register('ParallelNtuplizers',
+        False,
+        opts.VarParsing.multiplicity.singleton,
+        opts.VarParsing.varType.bool,
+        'Whether to run the ntuplizers of an event as concurrent tasks'
+    )
+
+   options.register('AsyncOutput',
+        False,
+        opts.VarParsing.multiplicity.singleton,
+        opts.VarParsing.varType.bool,
+        'Whether to fill the output tree asynchronously from a dedicated thread'
+    )
+
    options.setDefault('maxEvents', 100 )
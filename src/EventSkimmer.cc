@@ -0,0 +1,157 @@
+/*******************************************************************************
+*
+*  Filename    : EventSkimmer.cc
+*  Description : Implementation of the pre-fill event selection
+*
+*******************************************************************************/
+#include "bpkFrameWork/bprimeKit/interface/EventSkimmer.hpp"
+#include "bpkFrameWork/bprimeKit/interface/bprimeKit.hpp"
+#include "bpkFrameWork/bprimeKit/interface/format.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TBranch.h>
+#include <algorithm>
+#include <cmath>
+#include <fnmatch.h>
+#include <iostream>
+
+using namespace std;
+
+/*******************************************************************************
+*   Constructor
+*******************************************************************************/
+EventSkimmer::EventSkimmer( const edm::ParameterSet& iConfig, TTree* streamtree ) :
+  _trgbook( nullptr ),
+  _trgpacked( nullptr ),
+  _stats( "EventSkimmer" )
+{
+  for( const auto& lepparam : iConfig.getParameter<edm::VParameterSet>( "leptons" ) ){
+    AddObjectSelection( streamtree, lepparam, true );
+  }
+
+  for( const auto& jetparam : iConfig.getParameter<edm::VParameterSet>( "jets" ) ){
+    AddObjectSelection( streamtree, jetparam, false );
+  }
+
+  // Trigger path patterns resolved once to the TrgBook indices, or to the
+  // TrgFamily indices of the matching paths if only the families are booked
+  const auto triggerlist = iConfig.getParameter<std::vector<std::string> >( "triggers" );
+  const bool familyonly  = !streamtree->GetBranch( "EvtInfo.TrgBook" )
+                           && !streamtree->GetBranch( "EvtInfo.TrgBookPacked" );
+
+  for( const auto& pattern : triggerlist ){
+    bool found = false;
+
+    for( int i = 0; i < N_TRIGGER_BOOKINGS; ++i ){
+      if( fnmatch( pattern.c_str(), TriggerBooking[i], 0 ) != 0 ){ continue; }
+      const int idx = familyonly ? bprimeKit::GetTriggerFamilyIdx( bpk::TriggerFamily( TriggerBooking[i] ) ) : i;
+      if( std::find( _trgidxlist.begin(), _trgidxlist.end(), idx ) == _trgidxlist.end() ){
+        _trgidxlist.push_back( idx );
+      }
+      found = true;
+    }
+
+    if( !found ){
+      cerr << "Skim trigger [" << pattern << "] matches no booked trigger path" << endl;
+    }
+  }
+
+  // Reading the packed states if the dense TrgBook is not booked
+  if( !triggerlist.empty() ){
+    if( streamtree->GetBranch( "EvtInfo.TrgBook" ) ){
+      _trgbook = GetBuffer<Char_t>( streamtree, "EvtInfo.TrgBook" );
+    } else if( familyonly ){
+      _trgbook = GetBuffer<Char_t>( streamtree, "EvtInfo.TrgFamily" );
+    } else {
+      _trgpacked = GetBuffer<UInt_t>( streamtree, "EvtInfo.TrgBookPacked" );
+    }
+  }
+}
+
+/******************************************************************************/
+
+void
+EventSkimmer::AddObjectSelection( TTree* streamtree, const edm::ParameterSet& iConfig, const bool isLepton )
+{
+  ObjectSelection sel;
+  sel.collection = iConfig.getParameter<std::string>( "collection" );
+  sel.objtype    = isLepton ? iConfig.getParameter<int>( "leptonType" ) : 0;
+  sel.minpt      = iConfig.getParameter<double>( "minPt" );
+  sel.maxabseta  = iConfig.getParameter<double>( "maxAbsEta" );
+  sel.mincount   = iConfig.getParameter<int>( "minCount" );
+  sel.minht      = isLepton ? 0 : iConfig.getParameter<double>( "minHT" );
+
+  sel.size = GetBuffer<Int_t>( streamtree, sel.collection + ".Size" );
+  sel.pt   = GetBuffer<Float_t>( streamtree, sel.collection + ".Pt" );
+  sel.eta  = GetBuffer<Float_t>( streamtree, sel.collection + ".Eta" );
+  sel.type = sel.objtype ? GetBuffer<Int_t>( streamtree, sel.collection + ".LeptonType" ) : nullptr;
+
+  _objselectionlist.push_back( sel );
+}
+
+/******************************************************************************/
+
+// The selections read the ntuplizer buffers directly, the branches must be
+// booked in the stream tree (i.e. not removed with dropBranches).
+template<typename T>
+const T*
+EventSkimmer::GetBuffer( TTree* streamtree, const std::string& branchname )
+{
+  const TBranch* branch = streamtree->GetBranch( branchname.c_str() );
+  if( !branch ){
+    throw cms::Exception( "Configuration" )
+          << "Skim selection requires branch [" << branchname << "], which is not booked";
+  }
+  return (const T*)branch->GetAddress();
+}
+
+/*******************************************************************************
+*   Selection
+*******************************************************************************/
+bool
+EventSkimmer::Pass()
+{
+  ++_stats.EvtSeen;
+
+  for( const auto& sel : _objselectionlist ){
+    if( !PassObjects( sel ) ){ return false; }
+  }
+
+  if( !_trgidxlist.empty() && !PassTrigger() ){ return false; }
+
+  ++_stats.EvtStored;
+  return true;
+}
+
+/******************************************************************************/
+
+bool
+EventSkimmer::PassObjects( const ObjectSelection& sel ) const
+{
+  int count = 0;
+  double ht = 0;
+
+  for( int i = 0; i < *sel.size; ++i ){
+    if( sel.type && sel.type[i] != sel.objtype ){ continue; }
+    if( sel.pt[i] < sel.minpt ){ continue; }
+    if( fabs( sel.eta[i] ) > sel.maxabseta ){ continue; }
+    ++count;
+    ht += sel.pt[i];
+  }
+
+  return count >= sel.mincount && ht >= sel.minht;
+}
+
+/******************************************************************************/
+
+bool
+EventSkimmer::PassTrigger() const
+{
+  for( const int idx : _trgidxlist ){
+    const Char_t state = _trgbook ? _trgbook[idx] : bpk::UnpackTrgState( _trgpacked[idx / 16] >> ( 2 * ( idx % 16 ) ) );
+    if( state == 1 ){ return true; }
+  }
+
+  return false;
+}
@@ -7,6 +7,9 @@
 *******************************************************************************/
 #include "bpkFrameWork/bprimeKit/interface/EvtGenNtuplizer.hpp"
 
+#include <algorithm>
+#include <iostream>
+
 using namespace std;
 
 /*******************************************************************************
@@ -24,11 +27,22 @@ EvtGenNtuplizer::EvtGenNtuplizer( const edm::ParameterSet& iConfig, bprimeKit* b
   _genevttoken( GetToken<GenEventInfoProduct>( "genevtsrc" ) ),
   _genparticletoken( GetToken<vector<reco::GenParticle> >( "gensrc" ) ),
   _gendigitoken( GetToken<L1GlobalTriggerReadoutRecord>( "gtdigisrc" ) ),
+  _l1algtoken( GetToken<GlobalAlgBlkBxCollection>( "l1algsrc" ) ),
   _lhetoken( GetToken<LHEEventProduct>( "lhesrc" ) ),
 
   _mettriggertoken( GetToken<edm::TriggerResults>( "mettriggersrc" ) ),
   _metbadmutoken( GetToken<bool>( "metbadmusrc" ) ),
-  _metbadchadtoken( GetToken<bool>( "metbadchadsrc" ) )
+  _metbadchadtoken( GetToken<bool>( "metbadchadsrc" ) ),
+  _compacttrigger( iConfig.getParameter<bool>( "compactTrigger" ) ),
+  _familytrigger( iConfig.getParameter<bool>( "familyTrigger" ) ),
+  _runlevelmenu( iConfig.getParameter<bool>( "runLevelMenu" ) ),
+  _compactlheweights( iConfig.getParameter<bool>( "compactLHEWeights" ) ),
+  _trgnames( nullptr ),
+  _mettrgnames( nullptr ),
+  _prescalelist( nullptr ),
+  _prescalecolumn( 0 ),
+  _nocolumnwarned( false ),
+  _genselection( iConfig.getParameter<edm::ParameterSet>( "genSelection" ) )
 {
 
 }
@@ -44,14 +58,108 @@ EvtGenNtuplizer::~EvtGenNtuplizer()
 void
 EvtGenNtuplizer::RegisterTree( TTree* tree )
 {
-  EvtInfo.RegisterTree( tree );
-  GenInfo.RegisterTree( tree );
+  // Only one of the dense and packed trigger forms is written
+  std::vector<std::string> triggerdrop = _compacttrigger ?
+                                         std::vector<std::string>{ "TrgBook", "HLTbits", "L1", "TT" } :
+                                         std::vector<std::string>{ "*Packed" };
+  // The family states replace the TrgBook states
+  if( _familytrigger ){
+    triggerdrop.push_back( "TrgBook" );
+    triggerdrop.push_back( "TrgBookPacked" );
+  } else {
+    triggerdrop.push_back( "*TrgFamily" );
+  }
+  if( _runlevelmenu ){
+    triggerdrop.push_back( "HLTName2enum" );
+    triggerdrop.push_back( "HLTPrescaleFactor" );
+  }
+
+  // Per event weights either as ratios, with the IDs in the run tree, or in full
+  const std::vector<std::string> lhedrop = _compactlheweights ?
+                                           std::vector<std::string>{ "LHESystematic*" } :
+                                           std::vector<std::string>{ "LHEWeightRatio" };
+
+  EvtInfo.RegisterTree( tree, "EvtInfo", OutputFilter().Drop( triggerdrop ) );
+  GenInfo.RegisterTree( tree, "GenInfo", OutputFilter().Drop( lhedrop ) );
+}
+
+/******************************************************************************/
+
+std::string
+EvtGenNtuplizer::Name() const
+{
+  return "EvtInfo/GenInfo";
 }
 
 /******************************************************************************/
 
 void
-EvtGenNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+EvtGenNtuplizer::BeginRun( const edm::Run& iRun, const edm::EventSetup& iSetup )
+{
+  bool changed = true;
+  if( !_hltconfig.init( iRun, iSetup, "HLT", changed ) ){
+    cerr << "HLT configuration not found for run " << iRun.run() << ", prescales are not available" << endl;
+  }
+
+  // Prescale tables only apply to the run they were read in
+  _prescalecache.clear();
+  _prescalelist = nullptr;
+  _prescalelumi = edm::LuminosityBlockID();
+}
+
+/******************************************************************************/
+
+void
+EvtGenNtuplizer::FillRunInfo( const edm::Run& iRun, RunInfoBranches& runinfo )
+{
+  if( !_hltconfig.inited() || runinfo.nHLT > 0 ){ return; }// Filled by another stream
+
+  const unsigned npath = std::min( _hltconfig.size(), (unsigned)MAX_HLTPATHS );
+  unsigned ncolumn     = _hltconfig.prescaleSize();
+
+  if( npath < _hltconfig.size() ){
+    cerr << "Only storing " << npath << " of the " << _hltconfig.size() << " HLT paths of run " << iRun.run()
+         << ", raise MAX_HLTPATHS in interface/format.h" << endl;
+  }
+
+  if( npath > 0 && npath * ncolumn > MAX_HLTPRESCALES ){
+    cerr << "Only storing " << MAX_HLTPRESCALES / npath << " of the " << ncolumn << " prescale columns of run " << iRun.run()
+         << ", the joined prescales of the other columns are -1" << endl;
+    ncolumn = MAX_HLTPRESCALES / npath;
+  }
+
+  runinfo.nHLT = npath;
+  runinfo.HLTName_w.clear();
+
+  for( unsigned i = 0; i < npath; ++i ){
+    runinfo.HLTName_w.push_back( _hltconfig.triggerName( i ) );
+    runinfo.HLTName2enum[i] = bprimeKit::GetTriggerIdx( _hltconfig.triggerName( i ) );
+  }
+
+  // Column major: all paths of column 0, then column 1...
+  runinfo.nHLTPrescaleColumn = ncolumn;
+  runinfo.nHLTPrescale       = npath * ncolumn;
+
+  for( unsigned column = 0; column < ncolumn; ++column ){
+    for( unsigned i = 0; i < npath; ++i ){
+      runinfo.HLTPrescaleTable[column * npath + i] = _hltconfig.prescaleValue( column, _hltconfig.triggerName( i ) );
+    }
+  }
+}
+
+/******************************************************************************/
+
+void
+EvtGenNtuplizer::FillLumiInfo( const edm::LuminosityBlock&, LumiInfoBranches& lumiinfo )
+{
+  bpk::AddWeightCounts( lumiinfo, _lumicounts );
+  _lumicounts.Reset( true );
+}
+
+/******************************************************************************/
+
+void
+EvtGenNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
   iEvent.getByToken( _rhotoken,         _rhohandle      );
   iEvent.getByToken( _mettoken,         _methandle      );
@@ -64,17 +172,29 @@ EvtGenNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetu
   iEvent.getByToken( _genevttoken,      _genevthandle      );
   iEvent.getByToken( _lhetoken,         _lhehandle         );
   iEvent.getByToken( _gendigitoken,     _recordhandle      );
+  iEvent.getByToken( _l1algtoken,       _l1alghandle       );
 
   iEvent.getByToken( _mettriggertoken,  _mettriggerhandle );
   iEvent.getByToken( _metbadmutoken,    _metbadmuhandle   );
   iEvent.getByToken( _metbadchadtoken,  _metbadchadhandle );
 
-  bool changed = true;
-  _hltconfig.init( iEvent.getRun(), iSetup, "HLT", changed );
+  _trgnames    = &iEvent.triggerNames( *_triggerhandle );
+  _mettrgnames = &iEvent.triggerNames( *_mettriggerhandle );
+}
 
-  memset( &GenInfo, 0x00, sizeof( GenInfo ) );
-  memset( &EvtInfo, 0x00, sizeof( EvtInfo ) );
+/******************************************************************************/
+
+void
+EvtGenNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  GenInfo.Reset();
+  EvtInfo.Reset();
 
   FillGen( iEvent, iSetup );
   FillEvent( iEvent, iSetup );
+
+  // Counting every processed event, the skim selection is applied afterwards
+  ++_lumicounts.Events;
+
+  CountObjects( _genparticlehandle.isValid() ? _genparticlehandle->size() : 0, GenInfo.Size );
 }
@@ -7,6 +7,9 @@
 #include "bpkFrameWork/bprimeKit/interface/EvtGenNtuplizer.hpp"
 
 #include "FWCore/Common/interface/TriggerNames.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <iostream>
 
 using namespace std;
 
@@ -21,7 +24,7 @@ EvtGenNtuplizer::FillEvent( const edm::Event& iEvent, const edm::EventSetup& iSe
   EvtInfo.BxNo     = iEvent.bunchCrossing();
   EvtInfo.LumiNo   = iEvent.luminosityBlock();
   EvtInfo.Orbit    = iEvent.orbitNumber();
-  EvtInfo.nTrgBook = N_TRIGGER_BOOKINGS;
+  EvtInfo.nTrgBook = _familytrigger ? 0 : N_TRIGGER_BOOKINGS;
   EvtInfo.Rho      = *_rhohandle;
 
   // ----- Pile up information  -----------------------------------------------------------------------
@@ -105,61 +108,88 @@ EvtGenNtuplizer::FillEvent( const edm::Event& iEvent, const edm::EventSetup& iSe
 
   // ----- Level 1 trigger and technical trigger bits  ------------------------
   if( _recordhandle.isValid() ){
-    DecisionWord dWord = _recordhandle->decisionWord();
+    // Packed 64 bits per word, the dense arrays are only filled if written
+    const DecisionWord& dWord = _recordhandle->decisionWord();
     if( !dWord.empty() ){// if board not there this is zero
-      // loop over dec. bit to get total rate (no overlap)
-      for( int i = 0; i < 128; ++i ){
-        EvtInfo.L1[i] = dWord[i];
+      EvtInfo.nL1Packed = N_L1_WORDS;
+      for( int i = 0; i < 64 * N_L1_WORDS && i < (int)dWord.size(); ++i ){
+        if( dWord[i] ){ EvtInfo.L1Packed[i / 64] |= 1ull << ( i % 64 ); }
       }
     }
-    TechnicalTriggerWord tw = _recordhandle->technicalTriggerWord();
+    const TechnicalTriggerWord& tw = _recordhandle->technicalTriggerWord();
     if( !tw.empty() ){
-      // loop over dec. bit to get total rate (no overlap)
-      for( int i = 0; i < 64; ++i ){
-        EvtInfo.TT[i] = tw[i];
+      EvtInfo.nTTPacked = N_TT_WORDS;
+      for( int i = 0; i < 64 * N_TT_WORDS && i < (int)tw.size(); ++i ){
+        if( tw[i] ){ EvtInfo.TTPacked[i / 64] |= 1ull << ( i % 64 ); }
       }
     }
+
+    if( !_compacttrigger ){
+      for( int i = 0; i < 64 * N_L1_WORDS; ++i ){ EvtInfo.L1[i] = EvtInfo.L1Bit( i ); }
+      for( int i = 0; i < 64 * N_TT_WORDS; ++i ){ EvtInfo.TT[i] = EvtInfo.TTBit( i ); }
+    }
   }
 
   /*******************************************************************************
   *   Trigger variables
   *******************************************************************************/
-  const edm::TriggerNames& TrgNames = iEvent.triggerNames( *_triggerhandle );
+  const edm::TriggerNames& TrgNames = *_trgnames;
 
   // Getting trigger table
   EvtInfo.TrgCount = 0;
 
-  for( size_t i = 0; i < N_TRIGGER_BOOKINGS; ++i ){
-    unsigned int TrgIndex = TrgNames.triggerIndex( TriggerBooking[i] );
-    if( TrgIndex == TrgNames.size() ){
-      EvtInfo.TrgBook[i] = -4;// The trigger path is not known in this event.
-    } else if( !_triggerhandle->wasrun( TrgIndex ) ){
-      EvtInfo.TrgBook[i] = -3;// The trigger path was not included in this event.
-    } else if( !_triggerhandle->accept( TrgIndex ) ){
-      EvtInfo.TrgBook[i] = -2;// The trigger path was not accepted in this event.
-    } else if( _triggerhandle->error( TrgIndex ) ){
-      EvtInfo.TrgBook[i] = -1;// The trigger path has an error in this event.
-    } else {
-      EvtInfo.TrgBook[i] = +1;// It's triggered.
-      EvtInfo.TrgCount++;
+  if( TrgNames.parameterSetID() != _triggermenuid ){
+    UpdateBookingList( TrgNames );
+  }
+
+  if( !_familytrigger ){
+    // The trigger path is not known in this event.
+    std::fill( EvtInfo.TrgBook, EvtInfo.TrgBook + N_TRIGGER_BOOKINGS, -4 );
+
+    for( const auto& booking : _bookinglist ){
+      EvtInfo.TrgBook[booking.first] = TriggerState( booking.second );
+      if( EvtInfo.TrgBook[booking.first] == 1 ){
+        EvtInfo.TrgCount++;
+      }
+    }
+  } else {
+    // Same states per versionless path family instead of TrgBook, versions
+    // resolved per menu. TrgCount is the number of fired families.
+    EvtInfo.nTrgFamily = std::min( bpk::TriggerFamilyList().size(), (size_t)MAX_TRGFAMILIES );
+    std::fill( EvtInfo.TrgFamily, EvtInfo.TrgFamily + EvtInfo.nTrgFamily, -4 );
+
+    for( const auto& family : _familylist ){
+      EvtInfo.TrgFamily[family.first] = TriggerState( family.second );
+      if( EvtInfo.TrgFamily[family.first] == 1 ){
+        EvtInfo.TrgCount++;
+      }
     }
   }
 
-  EvtInfo.nHLT = TrgNames.size();
+  // Same truncation as the run level menu, see FillRunInfo()
+  EvtInfo.nHLT = std::min( TrgNames.size(), (size_t)MAX_HLTPATHS );
 
-  // TODO Assuming prescale set = 0 , check.
-  // Enoch 2016-02-04
-  for( size_t i = 0; i < TrgNames.size(); ++i ){
-    const std::string name = TrgNames.triggerName( i );
+  const edm::LuminosityBlockID lumi( iEvent.id().run(), iEvent.id().luminosityBlock() );
+  if( !_prescalelist || lumi != _prescalelumi ){
+    UpdatePrescaleList( lumi, TrgNames, iEvent.isRealData() );
+  }
+
+  for( int i = 0; i < EvtInfo.nHLT; ++i ){
     EvtInfo.HLTbits[i]           = _triggerhandle->accept( i ) ? 1 : 0;
-    EvtInfo.HLTPrescaleFactor[i] = _hltconfig.prescaleValue( 0, name );
-    EvtInfo.HLTName2enum[i]      = bprimeKit::GetTriggerIdx( name );
+    EvtInfo.HLTPrescaleFactor[i] = ( *_prescalelist )[i];
+    EvtInfo.HLTName2enum[i]      = _menuname2enum[i];
+  }
+
+  EvtInfo.HLTPrescaleColumn = _prescalecolumn;
+
+  if( _compacttrigger ){
+    EvtInfo.PackTrigger();
   }
 
   /*******************************************************************************
   *   MET filter requirements
   *******************************************************************************/
-  const edm::TriggerNames& mettriggername = iEvent.triggerNames( *_mettriggerhandle );
+  const edm::TriggerNames& mettriggername = *_mettrgnames;
 
   // lambda function for MET filter trigger parsing
   auto checkMETfilter
@@ -183,3 +213,109 @@ EvtGenNtuplizer::FillEvent( const edm::Event& iEvent, const edm::EventSetup& iSe
     );
 
 }
+
+/******************************************************************************/
+
+void
+EvtGenNtuplizer::UpdateBookingList( const edm::TriggerNames& TrgNames )
+{
+  _triggermenuid = TrgNames.parameterSetID();
+  _bookinglist.clear();
+
+  // Prescales are cached per menu index
+  _prescalecache.clear();
+  _prescalelist = nullptr;
+
+  // Only one of the TrgBook and TrgFamily states is filled
+  for( unsigned i = 0; i < N_TRIGGER_BOOKINGS && !_familytrigger; ++i ){
+    const unsigned TrgIndex = TrgNames.triggerIndex( TriggerBooking[i] );
+    if( TrgIndex != TrgNames.size() ){
+      _bookinglist.emplace_back( i, TrgIndex );
+    }
+  }
+
+  _menuname2enum.clear();
+
+  for( unsigned i = 0; i < TrgNames.size(); ++i ){
+    _menuname2enum.push_back( bprimeKit::GetTriggerIdx( TrgNames.triggerName( i ) ) );
+  }
+
+  // Resolving the path version of every family present in the menu, any
+  // version matches, including versions not in the TriggerBooking. The first
+  // menu path is used if a family appears more than once.
+  _familylist.clear();
+  std::vector<bool> found( bpk::TriggerFamilyList().size(), false );
+
+  for( unsigned i = 0; i < TrgNames.size() && _familytrigger; ++i ){
+    const int familyidx = bprimeKit::GetTriggerFamilyIdx( bpk::TriggerFamily( TrgNames.triggerName( i ) ) );
+    if( familyidx < 0 || familyidx >= MAX_TRGFAMILIES || found[familyidx] ){ continue; }
+    found[familyidx] = true;
+    _familylist.emplace_back( familyidx, i );
+  }
+}
+
+/******************************************************************************/
+
+// Selecting the prescales of the active prescale column, called on the first
+// event of every luminosity block. The HLT columns follow the L1 columns, the
+// column is read from the Stage-2 L1 algorithm block (gtStage2Digis, 2016), or
+// from the legacy L1 GT final decision word. Data without either is an error,
+// MC falls back to column 0. The prescales of a column are only looked up by
+// name the first time the column is used in the run.
+void
+EvtGenNtuplizer::UpdatePrescaleList( const edm::LuminosityBlockID& lumi, const edm::TriggerNames& TrgNames, const bool isdata )
+{
+  _prescalelumi = lumi;
+
+  unsigned column = 0;
+  if( _l1alghandle.isValid() && !_l1alghandle->isEmpty( 0 ) ){
+    column = _l1alghandle->begin( 0 )->getPreScColumn();
+  } else if( _recordhandle.isValid() ){
+    column = _recordhandle->gtFdlWord().gtPrescaleFactorIndexAlgo();
+  } else if( isdata ){
+    throw cms::Exception( "ProductNotFound" )
+          << "No L1 record (l1algsrc or gtdigisrc) for the prescale column of " << _prescalelumi;
+  } else if( !_nocolumnwarned ){
+    cerr << "No L1 record (l1algsrc or gtdigisrc) for the prescale column, using column 0" << endl;
+    _nocolumnwarned = true;
+  }
+
+  if( _hltconfig.prescaleSize() > 0 && column >= _hltconfig.prescaleSize() ){
+    cerr << "Prescale column " << column << " not in the HLT menu for " << _prescalelumi
+         << ", using column 0" << endl;
+    column = 0;
+  }
+
+  _prescalecolumn = column;
+
+  auto cache = _prescalecache.find( column );
+
+  if( cache == _prescalecache.end() ){
+    std::vector<int> prescalelist;
+    prescalelist.reserve( TrgNames.size() );
+
+    for( unsigned i = 0; i < TrgNames.size(); ++i ){
+      prescalelist.push_back( _hltconfig.inited() ? _hltconfig.prescaleValue( column, TrgNames.triggerName( i ) ) : 1 );
+    }
+
+    cache = _prescalecache.emplace( column, std::move( prescalelist ) ).first;
+  }
+
+  _prescalelist = &cache->second;
+}
+
+/******************************************************************************/
+
+Char_t
+EvtGenNtuplizer::TriggerState( const unsigned TrgIndex ) const
+{
+  if( !_triggerhandle->wasrun( TrgIndex ) ){
+    return -3;// The trigger path was not included in this event.
+  } else if( !_triggerhandle->accept( TrgIndex ) ){
+    return -2;// The trigger path was not accepted in this event.
+  } else if( _triggerhandle->error( TrgIndex ) ){
+    return -1;// The trigger path has an error in this event.
+  } else {
+    return +1;// It's triggered.
+  }
+}
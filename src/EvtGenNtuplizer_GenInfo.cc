@@ -6,8 +6,101 @@
 *******************************************************************************/
 #include "bpkFrameWork/bprimeKit/interface/EvtGenNtuplizer.hpp"
 
+#include <algorithm>
+#include <iostream>
+
 using namespace std;
 
+/*******************************************************************************
+*   Gen particle selection
+*******************************************************************************/
+EvtGenNtuplizer::GenSelection::GenSelection( const edm::ParameterSet& iConfig ) :
+  maxsize( iConfig.getParameter<int>( "maxSize" ) ),
+  statuslist( iConfig.getParameter<std::vector<int> >( "status" ) ),
+  pdgidlist( iConfig.getParameter<std::vector<int> >( "pdgIds" ) ),
+  lastcopy( iConfig.getParameter<bool>( "lastCopy" ) ),
+  hardprocess( iConfig.getParameter<bool>( "hardProcess" ) ),
+  ancestors( iConfig.getParameter<bool>( "keepAncestors" ) )
+{
+  if( maxsize > MAX_GENS || maxsize < 0 ){
+    cerr << "Gen particle maxSize " << maxsize << " out of range, storing at most " << MAX_GENS << endl;
+    maxsize = MAX_GENS;
+  }
+
+  for( auto& pdgid : pdgidlist ){
+    pdgid = abs( pdgid );
+  }
+}
+
+/******************************************************************************/
+
+bool
+EvtGenNtuplizer::GenSelection::Pass( const reco::GenParticle& particle ) const
+{
+  if( !statuslist.empty() && std::find( statuslist.begin(), statuslist.end(), particle.status() ) == statuslist.end() ){
+    return false;
+  }
+  if( !pdgidlist.empty() && std::find( pdgidlist.begin(), pdgidlist.end(), abs( particle.pdgId() ) ) == pdgidlist.end() ){
+    return false;
+  }
+  if( lastcopy && !particle.isLastCopy() ){ return false; }
+  if( hardprocess && !particle.isHardProcess() ){ return false; }
+  return true;
+}
+
+/******************************************************************************/
+
+int
+EvtGenNtuplizer::GenIndex( const reco::Candidate* particle ) const
+{
+  const auto found = _genindexmap.find( particle );
+  return found != _genindexmap.end() ? found->second : -1;
+}
+
+/******************************************************************************/
+
+// Marking the selected particles and optionally their ancestors, then
+// assigning the GenInfo indices in collection order up to the size limit.
+// Requires the index map of the current event.
+void
+EvtGenNtuplizer::SelectGen()
+{
+  const auto& gens = *_genparticlehandle;
+  std::vector<int> ancestorlist;
+
+  _genstoreidx.assign( gens.size(), -1 );
+
+  for( size_t i = 0; i < gens.size(); ++i ){
+    if( _genstoreidx[i] == 0 || !_genselection.Pass( gens[i] ) ){ continue; }
+
+    _genstoreidx[i] = 0;
+    if( !_genselection.ancestors ){ continue; }
+
+    ancestorlist.push_back( i );
+
+    while( !ancestorlist.empty() ){
+      const auto& particle = gens[ancestorlist.back()];
+      ancestorlist.pop_back();
+
+      for( size_t j = 0; j < particle.numberOfMothers(); ++j ){
+        const int mother = GenIndex( particle.mother( j ) );
+        if( mother >= 0 && _genstoreidx[mother] != 0 ){
+          _genstoreidx[mother] = 0;
+          ancestorlist.push_back( mother );
+        }
+      }
+    }
+  }
+
+  int size = 0;
+
+  for( auto& storeidx : _genstoreidx ){
+    if( storeidx == 0 ){
+      storeidx = size < _genselection.maxsize ? size++ : -1;
+    }
+  }
+}
+
 /*******************************************************************************
 *   Main control flow
 *******************************************************************************/
@@ -21,11 +114,7 @@ EvtGenNtuplizer::FillGen( const edm::Event& iEvent, const edm::EventSetup& iSetu
   const reco::Candidate* MCDaughters[14];
   const reco::Candidate* dau1;
   const reco::Candidate* dau2;
-  std::vector<const reco::Candidate*> cands;
-  std::vector<const reco::Candidate*>::const_iterator found;
-  std::vector<const reco::Candidate*>::const_iterator daughter1, daughter2;
-  std::vector<const reco::Candidate*>::const_iterator mother1, mother2;
-  std::vector<const reco::Candidate*>::const_iterator gmother1, gmother2;
+  int mother1, mother2, gmother1, gmother2, daughter1, daughter2;
   int NMo, NDa;
   int pdgId, dauId1, dauId2, monId;
 
@@ -43,10 +132,18 @@ EvtGenNtuplizer::FillGen( const edm::Event& iEvent, const edm::EventSetup& iSetu
   }
 
 
+  // Collection index of every particle, for resolving the mother/daughter
+  // pointers without scanning the collection
+  _genindexmap.clear();
+  _genindexmap.reserve( _genparticlehandle->size() );
+
   for( auto it_gen = _genparticlehandle->begin(); it_gen != _genparticlehandle->end(); it_gen++ ){
-    cands.push_back( &*it_gen );
+    _genindexmap.emplace( &*it_gen, it_gen - _genparticlehandle->begin() );
   }
 
+  SelectGen();
+  const auto& gens = *_genparticlehandle;
+
   // Event wide objects
   GenInfo.Weight            = _genevthandle->weight();
   EvtInfo.ptHat             = _genevthandle->qScale();
@@ -54,25 +151,40 @@ EvtGenNtuplizer::FillGen( const edm::Event& iEvent, const edm::EventSetup& iSetu
   GenInfo.LHEOriginalWeight = _lhehandle->originalXWGTUP();
   GenInfo.LHESize           = std::min( MAX_LHE, (int)( _lhehandle->weights().size() ) );
 
+  // Summed in double precision, before the conversion to the branch types
+  const double weight       = _genevthandle->weight();
+  _lumicounts.SumWeight    += weight;
+  _lumicounts.SumWeight2   += weight * weight;
+  _lumicounts.nSumLHEWeight = std::max( _lumicounts.nSumLHEWeight, GenInfo.LHESize );
+
   for( int i = 0; i < GenInfo.LHESize; ++i ){
-    GenInfo.LHESystematicWeights[i] = _lhehandle->weights().at( i ).wgt;
-    GenInfo.LHESystematicId[i]      = std::stoi( _lhehandle->weights().at( i ).id.data() );
+    _lumicounts.SumLHEWeight[i] += _lhehandle->weights()[i].wgt;
+  }
+
+  if( _compactlheweights ){
+    // Only the ratios to the nominal weight, the IDs are stored in the run tree
+    const double nominal    = GenInfo.LHENominalWeight;
+    GenInfo.nLHEWeightRatio = GenInfo.LHESize;
+
+    for( int i = 0; i < GenInfo.LHESize; ++i ){
+      GenInfo.LHEWeightRatio[i] = bpk::FloatToHalf( nominal != 0 ? _lhehandle->weights()[i].wgt / nominal : 0 );
+    }
+  } else {
+    for( int i = 0; i < GenInfo.LHESize; ++i ){
+      GenInfo.LHESystematicWeights[i] = _lhehandle->weights().at( i ).wgt;
+      GenInfo.LHESystematicId[i]      = std::stoi( _lhehandle->weights().at( i ).id.data() );
+    }
   }
 
   /*******************************************************************************
-  *   Gen particle loop
+  *   Gen particle loop, particles passing genSelection
   *******************************************************************************/
   for( auto it_gen = _genparticlehandle->begin(); it_gen != _genparticlehandle->end(); ++it_gen  ){
-
-    // ----- Setting up common variable  -------------------------------------
-    dauId1 = dauId2 = monId = 0;
-    dau1   = dau2 = NULL;
-    pdgId  = it_gen->pdgId();
-    NMo    = it_gen->numberOfMothers();
-    NDa    = it_gen->numberOfDaughters();
+    NMo = it_gen->numberOfMothers();
+    NDa = it_gen->numberOfDaughters();
 
     // ----- GenInfo Branch insertion  --------------------------------------
-    if( GenInfo.Size < 60 ){
+    if( _genstoreidx[it_gen - _genparticlehandle->begin()] >= 0 ){
       GenInfo.Pt             [GenInfo.Size] = it_gen->pt();
       GenInfo.Eta            [GenInfo.Size] = it_gen->eta();
       GenInfo.Phi            [GenInfo.Size] = it_gen->phi();
@@ -97,59 +209,55 @@ EvtGenNtuplizer::FillGen( const edm::Event& iEvent, const edm::EventSetup& iSetu
       GenInfo.GrandMo2Status [GenInfo.Size] = -1;
 
       // ----- Parent/Daughter information insertion  -----------------------
-      mother1 = find( cands.begin(), cands.end(), it_gen->mother( 0 ) );
-      if( mother1 != cands.end() ){
-        GenInfo.Mo1       [GenInfo.Size] = mother1 - cands.begin();
-        GenInfo.Mo1PdgID  [GenInfo.Size] = ( *mother1 )->pdgId();
-        GenInfo.Mo1Status [GenInfo.Size] = ( *mother1 )->status();
-        gmother1                         = find( cands.begin(), cands.end(), ( *mother1 )->mother( 0 ) );
-        if( gmother1 != cands.end() ){
-          GenInfo.GrandMo1PdgID [GenInfo.Size] = ( *gmother1 )->pdgId();
-          GenInfo.GrandMo1Status[GenInfo.Size] = ( *gmother1 )->status();
+      mother1 = GenIndex( it_gen->mother( 0 ) );
+      if( mother1 >= 0 ){
+        GenInfo.Mo1       [GenInfo.Size] = _genstoreidx[mother1];
+        GenInfo.Mo1PdgID  [GenInfo.Size] = gens[mother1].pdgId();
+        GenInfo.Mo1Status [GenInfo.Size] = gens[mother1].status();
+        gmother1                         = GenIndex( gens[mother1].mother( 0 ) );
+        if( gmother1 >= 0 ){
+          GenInfo.GrandMo1PdgID [GenInfo.Size] = gens[gmother1].pdgId();
+          GenInfo.GrandMo1Status[GenInfo.Size] = gens[gmother1].status();
         }
       }
-      mother2 = find( cands.begin(), cands.end(), it_gen->mother( NMo-1 ) );
-      if( mother2 != cands.end() ){
-        GenInfo.Mo2       [GenInfo.Size] = mother2 - cands.begin();
-        GenInfo.Mo2PdgID  [GenInfo.Size] = ( *mother2 )->pdgId();
-        GenInfo.Mo2Status [GenInfo.Size] = ( *mother2 )->status();
-        gmother2                         = find( cands.begin(), cands.end(), ( *mother2 )->mother( 0 ) );
-        if( gmother2 != cands.end() ){
-          GenInfo.GrandMo2PdgID [GenInfo.Size] = ( *gmother2 )->pdgId();
-          GenInfo.GrandMo2Status[GenInfo.Size] = ( *gmother2 )->status();
+      mother2 = GenIndex( it_gen->mother( NMo-1 ) );
+      if( mother2 >= 0 ){
+        GenInfo.Mo2       [GenInfo.Size] = _genstoreidx[mother2];
+        GenInfo.Mo2PdgID  [GenInfo.Size] = gens[mother2].pdgId();
+        GenInfo.Mo2Status [GenInfo.Size] = gens[mother2].status();
+        gmother2                         = GenIndex( gens[mother2].mother( 0 ) );
+        if( gmother2 >= 0 ){
+          GenInfo.GrandMo2PdgID [GenInfo.Size] = gens[gmother2].pdgId();
+          GenInfo.GrandMo2Status[GenInfo.Size] = gens[gmother2].status();
         }
       }
-      daughter1 = find( cands.begin(), cands.end(), it_gen->daughter( 0 ) );
-      if( daughter1 != cands.end() ){
-        GenInfo.Da1 [GenInfo.Size]      = daughter1 - cands.begin();
-        GenInfo.Da1PdgID [GenInfo.Size] = it_gen->daughter( 0 )->pdgId();
+      daughter1 = GenIndex( it_gen->daughter( 0 ) );
+      if( daughter1 >= 0 ){
+        GenInfo.Da1 [GenInfo.Size]      = _genstoreidx[daughter1];
+        GenInfo.Da1PdgID [GenInfo.Size] = gens[daughter1].pdgId();
       }
-      daughter2 = find( cands.begin(), cands.end(), it_gen->daughter( NDa-1 ) );
-      if( daughter2 != cands.end() ){
-        GenInfo.Da2 [GenInfo.Size]      = daughter2 - cands.begin();
-        GenInfo.Da2PdgID [GenInfo.Size] = it_gen->daughter( NDa-1 )->pdgId();
+      daughter2 = GenIndex( it_gen->daughter( NDa-1 ) );
+      if( daughter2 >= 0 ){
+        GenInfo.Da2 [GenInfo.Size]      = _genstoreidx[daughter2];
+        GenInfo.Da2PdgID [GenInfo.Size] = gens[daughter2].pdgId();
       }
 
       // ----- Photon Flag, see definition below  ---------------------------
       GenInfo.PhotonFlag[GenInfo.Size] = PhotonFlag( it_gen );
       ++GenInfo.Size;
-
-      // ----- Getting information for ljmet algorithm  ---------------------
-      if( !IsTprime( it_gen->pdgId() ) || HasTprimeDaughter( it_gen ) ){ continue; }
-
-      for( size_t i = 0; i < it_gen->numberOfDaughters(); ++i ){
-        int daughterId = it_gen->daughter( i )->pdgId();
-        if( abs( daughterId ) == 5 || abs( daughterId ) == 6 ){
-          quarkID.push_back( daughterId );
-        } else if( abs( daughterId ) > 22 && abs( daughterId ) < 26 ){
-          bosonID.push_back( daughterId );
-        }
-      }
     }
+  }
+
+  /*******************************************************************************
+  *   Event level information, from every particle regardless of genSelection
+  *******************************************************************************/
+  for( auto it_gen = _genparticlehandle->begin(); it_gen != _genparticlehandle->end(); ++it_gen  ){
+    dauId1 = dauId2 = monId = 0;
+    dau1   = dau2 = NULL;
+    pdgId  = it_gen->pdgId();
+    NMo    = it_gen->numberOfMothers();
+    NDa    = it_gen->numberOfDaughters();
 
-    // -----------------------------------------------------------------------
-    //   Inserting Event Level information
-    // -----------------------------------------------------------------------
     if( NDa >= 2 ){
       dau1   = it_gen->daughter( 0 );
       dau2   = it_gen->daughter( 1 );
@@ -319,6 +427,21 @@ EvtGenNtuplizer::FillGen( const edm::Event& iEvent, const edm::EventSetup& iSetu
     EvtInfo.McDauPdgID[i] = MCDaughters[i]->pdgId();
   }
 
+  // ----- Getting information for ljmet algorithm  -------------------------
+  // From every last copy T' of the event, independent of the stored particles
+  for( auto it_gen = _genparticlehandle->begin(); it_gen != _genparticlehandle->end(); ++it_gen ){
+    if( !IsTprime( it_gen->pdgId() ) || HasTprimeDaughter( it_gen ) ){ continue; }
+
+    for( size_t i = 0; i < it_gen->numberOfDaughters(); ++i ){
+      int daughterId = it_gen->daughter( i )->pdgId();
+      if( abs( daughterId ) == 5 || abs( daughterId ) == 6 ){
+        quarkID.push_back( daughterId );
+      } else if( abs( daughterId ) > 22 && abs( daughterId ) < 26 ){
+        bosonID.push_back( daughterId );
+      }
+    }
+  }
+
   // --------------------------------------------------------------------------
   //   Begin main part of ljmet algorithm
   //   Main reference: https://github.com/cms-ljmet/Ljmet-Com/blob/master/src/TpTpCalc.cc
@@ -18,6 +18,8 @@
 
 #include "CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h"
 #include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+#include "CondFormats/DataRecord/interface/JetResolutionRcd.h"
+#include "CondFormats/DataRecord/interface/JetResolutionScaleFactorRcd.h"
 #include "JetMETCorrections/Modules/interface/JetResolution.h"
 #include "JetMETCorrections/Objects/interface/JetCorrectionsRecord.h"
 
@@ -76,32 +78,51 @@ JetNtuplizer::~JetNtuplizer()
 void
 JetNtuplizer::RegisterTree( TTree* tree )
 {
-  JetInfo.RegisterTree( tree, _jetname );
+  JetInfo.RegisterTree( tree, _jetname, OutputFilter() );
+}
+
+/******************************************************************************/
+
+std::string
+JetNtuplizer::Name() const
+{
+  return _jetname;
 }
 
 /******************************************************************************/
 
 void
-JetNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+JetNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
-  edm::ESHandle<JetCorrectorParametersCollection> jetCorParColl;
   iEvent.getByToken( _rhotoken,    _rhohandle );
   iEvent.getByToken( _jettoken,    _jethandle );
   iEvent.getByToken( _vtxtoken,    _vtxhandle );
   iEvent.getByToken( _muontoken,   _muonhandle );
   iEvent.getByToken( _subjettoken, _subjethandle );
 
-  memset( &JetInfo, 0x00, sizeof( JetInfo ) );
+  // Same records as JME::JetResolution(ScaleFactor)::get()
+  iSetup.get<JetCorrectionsRecord>().get( _jettype.c_str(), _jetcorparhandle );
+  iSetup.get<JetResolutionRcd>().get( _jettype + "_pt", _jetptreshandle );
+  iSetup.get<JetResolutionRcd>().get( _jettype + "_phi", _jetphireshandle );
+  iSetup.get<JetResolutionScaleFactorRcd>().get( _jettype, _jetressfhandle );
+}
+
+/******************************************************************************/
+
+void
+JetNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  JetInfo.Reset();
+  _genmctagcache.clear();
 
   const double pt_cut = IsAK4() ? 15. : 100;
 
-  iSetup.get<JetCorrectionsRecord>().get( _jettype.c_str(), jetCorParColl );
-  const JetCorrectorParameters& jetCorPar = ( *jetCorParColl )["Uncertainty"];
+  const JetCorrectorParameters& jetCorPar = ( *_jetcorparhandle )["Uncertainty"];
   JetCorrectionUncertainty jecUnc( jetCorPar );
 
-  const JME::JetResolution jetptres( JME::JetResolution::get( iSetup, _jettype + "_pt" ) );
-  const JME::JetResolution jetphires( JME::JetResolution::get( iSetup, _jettype + "_phi" ) );
-  const JME::JetResolutionScaleFactor jetressf( JME::JetResolutionScaleFactor::get( iSetup, _jettype ) );
+  const JME::JetResolution jetptres( *_jetptreshandle );
+  const JME::JetResolution jetphires( *_jetphireshandle );
+  const JME::JetResolutionScaleFactor jetressf( *_jetressfhandle );
 
   // Beginning maing jet loop
   for( auto it_jet = _jethandle->begin(); it_jet != _jethandle->end(); it_jet++ ){
@@ -288,11 +309,13 @@ JetNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
         JetInfo.GenPdgID  [JetInfo.Size]      = parton->pdgId();
         JetInfo.GenFlavor [JetInfo.Size]      = it_jet->partonFlavour();
         JetInfo.GenHadronFlavor[JetInfo.Size] = it_jet->hadronFlavour();
-        JetInfo.GenMCTag  [JetInfo.Size]      = bprimeKit::GetGenMCTag( parton );
+        JetInfo.GenMCTag  [JetInfo.Size]      = bprimeKit::GetGenMCTag( parton, _genmctagcache );
       }
     }
     JetInfo.Size++;
   }
+
+  CountObjects( _jethandle->size(), JetInfo.Size );
 }
 
 /*******************************************************************************
@@ -47,13 +47,21 @@ LeptonNtuplizer::~LeptonNtuplizer()
 void
 LeptonNtuplizer::RegisterTree( TTree* tree )
 {
-  LepInfo.RegisterTree( tree, _leptonname );
+  LepInfo.RegisterTree( tree, _leptonname, OutputFilter() );
+}
+
+/******************************************************************************/
+
+std::string
+LeptonNtuplizer::Name() const
+{
+  return _leptonname;
 }
 
 /******************************************************************************/
 
 void
-LeptonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+LeptonNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
   iEvent.getByToken( _rhotoken,               _rhohandle      );
   iEvent.getByToken( _muontoken,              _muonhandle     );
@@ -70,13 +78,21 @@ LeptonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetu
   iEvent.getByToken( _electronID_mediumtoken, _electronIDMedium );
   iEvent.getByToken( _electronID_tighttoken,  _electronIDTight  );
   iEvent.getByToken( _electronID_HEEPtoken,   _electronIDHEEP   );
+}
+
+/******************************************************************************/
 
-  memset( &LepInfo, 0x00, sizeof( LepInfo ) );
+void
+LeptonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  LepInfo.Reset();
+  _genmctagcache.clear();
 
   FillMuon( iEvent, iSetup  );
   FillElectron( iEvent, iSetup  );
   FillTau( iEvent, iSetup  );
 
+  CountObjects( _muonhandle->size() + _electronhandle->size() + _tauhandle->size(), LepInfo.Size );
 }
 
 /*******************************************************************************
@@ -143,7 +143,7 @@ LeptonNtuplizer::FillElectron( const edm::Event& iEvent, const edm::EventSetup&
         LepInfo.GenEta       [LepInfo.Size] = gen->eta();
         LepInfo.GenPhi       [LepInfo.Size] = gen->phi();
         LepInfo.GenPdgID     [LepInfo.Size] = gen->pdgId();
-        LepInfo.GenMCTag     [LepInfo.Size] = bprimeKit::GetGenMCTag( gen );
+        LepInfo.GenMCTag     [LepInfo.Size] = bprimeKit::GetGenMCTag( gen, _genmctagcache );
       }
       if( LepInfo.GenMCTag[LepInfo.Size] == 0 ){
         LepInfo.GenMCTag     [LepInfo.Size] = GetGenMCTag( it_el );
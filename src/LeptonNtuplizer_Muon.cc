@@ -165,7 +165,7 @@ LeptonNtuplizer::FillMuon( const edm::Event& iEvent, const edm::EventSetup& iSet
         LepInfo.GenEta   [LepInfo.Size] = gen->eta();
         LepInfo.GenPhi   [LepInfo.Size] = gen->phi();
         LepInfo.GenPdgID [LepInfo.Size] = gen->pdgId();
-        LepInfo.GenMCTag [LepInfo.Size] = bprimeKit::GetGenMCTag( gen );
+        LepInfo.GenMCTag [LepInfo.Size] = bprimeKit::GetGenMCTag( gen, _genmctagcache );
       }
     }
     if( LepInfo.GenMCTag[LepInfo.Size] == 0 && !iEvent.isRealData() ){
@@ -0,0 +1,558 @@
+/*******************************************************************************
+*
+*  Filename    : NtupleWriter.cc
+*  Description : Implementation of the job wide output handler
+*
+*******************************************************************************/
+#include "bpkFrameWork/bprimeKit/interface/NtupleWriter.hpp"
+
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+/*******************************************************************************
+*   Constructor and destructor
+*******************************************************************************/
+NtupleWriter::NtupleWriter( const edm::ParameterSet& iConfig ) :
+  _compression( CompressionSettings(
+      iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<std::string>( "compressionAlgorithm" ),
+      iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<int>( "compressionLevel" ) ) ),
+  _autoflush( iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<long long>( "autoFlush" ) ),
+  _async( iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<bool>( "asyncFill" ) ),
+  _rolloversize( iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<long long>( "rolloverSizeMB" ) * 1024 * 1024 ),
+  _rolloverevents( iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<long long>( "rolloverEvents" ) ),
+  _rolloverlumi( iConfig.getParameter<edm::ParameterSet>( "outputsetting" ).getParameter<bool>( "rolloverLumi" ) ),
+  _dir( nullptr ),
+  _runtree( nullptr ),
+  _lumitree( nullptr ),
+  _perftree( nullptr ),
+  _eventtree( nullptr ),
+  _lastsource( nullptr ),
+  _fillstats( "NtupleWriter::Fill" ),
+  _fileindex( 0 ),
+  _fileentries( 0 ),
+  _flushedzipbytes( 0 ),
+  _pendingbytes( 0 ),
+  _stopfilling( false )
+{
+  const auto& outputsetting = iConfig.getParameter<edm::ParameterSet>( "outputsetting" );
+
+  for( const auto& basket : outputsetting.getParameter<edm::VParameterSet>( "basketSizes" ) ){
+    _basketsizes.emplace_back(
+      basket.getParameter<std::string>( "branches" ),
+      basket.getParameter<int>( "size" ) );
+  }
+}
+
+/******************************************************************************/
+
+NtupleWriter::~NtupleWriter()
+{
+  /***** DO NOT DELETE TREES! Handled by the TFileService  *********************/
+  StopFillThread();
+}
+
+/*******************************************************************************
+*
+*  Note :
+*    1. All writing objects (TTrees, TH1Fs) MUST be created here and
+*       not in the analyzer constructor!!
+*    2. Do not use the WRITE functions and delete operator!! These are
+*       automatically handled by the TFileService instance.
+*
+*******************************************************************************/
+void
+NtupleWriter::BeginJob()
+{
+  /***** MADITORY!! DO NOT REMOVE  *********************************************/
+  edm::Service<TFileService> fs;
+  TFileDirectory subDir = fs->mkdir( "mySubDirectory" );
+  /******************************************************************************/
+
+  // Set before creating any tree, branches take the file settings on creation
+  fs->file().SetCompressionSettings( _compression );
+
+  _dir     = fs->getBareDirectory();
+  _runtree = fs->make<TTree>( "run", "run" );
+  _runinfo.RegisterTree( _runtree );
+  _lumitree = fs->make<TTree>( "lumi", "lumi" );
+  _lumiinfo.RegisterTree( _lumitree );
+  _perftree = fs->make<TTree>( "perf", "perf" );
+
+  // Rollover files are named after the TFileService file: out.root -> out_<N>.root
+  if( IsRollover() ){
+    _filebase = fs->file().GetName();
+    if( _filebase.size() > 5 && _filebase.compare( _filebase.size() - 5, 5, ".root" ) == 0 ){
+      _filebase.erase( _filebase.size() - 5 );
+    }
+    OpenFile();
+  }
+
+  if( _async ){
+    _fillthread = std::thread( &NtupleWriter::FillLoop, this );
+  }
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::EndJob()
+{
+  // Flushing the remaining requests, normally already waited for by endStream
+  StopFillThread();
+
+  // The rollover files are not handled by the TFileService. All runs have
+  // ended by now, so only the current file is expected here.
+  for( auto& outputfile : _filelist ){
+    if( !outputfile.runlist.empty() ){
+      cerr << "Run information missing for " << outputfile.runlist.size()
+           << " runs of [" << outputfile.name << "]" << endl;
+      outputfile.runlist.clear();
+    }
+
+    if( outputfile.file ){
+      CloseFile( outputfile );
+    } else {
+      CompleteFile( outputfile );
+    }
+  }
+
+  _filelist.clear();
+
+  std::vector<NtuplizerStats> statlist( _statlist );
+  statlist.push_back( _fillstats );
+
+  NtuplizerStats::PrintTable( cout, statlist );
+
+  PerfInfoBranches perfinfo;
+  perfinfo.RegisterTree( _perftree );
+
+  for( const auto& stat : statlist ){
+    strncpy( perfinfo.Name, stat.Name.c_str(), sizeof( perfinfo.Name ) - 1 );
+    perfinfo.Name[sizeof( perfinfo.Name ) - 1] = '\0';
+    perfinfo.Calls           = stat.Calls;
+    perfinfo.WallTime        = stat.WallTime;
+    perfinfo.CpuTime         = stat.CpuTime;
+    perfinfo.RegisterTime    = stat.RegisterTime;
+    perfinfo.RegisterCpuTime = stat.RegisterCpuTime;
+    perfinfo.ObjSeen         = stat.ObjSeen;
+    perfinfo.ObjStored       = stat.ObjStored;
+    perfinfo.EvtSeen         = stat.EvtSeen;
+    perfinfo.EvtStored       = stat.EvtStored;
+    _perftree->Fill();
+  }
+
+  _perftree->ResetBranchAddresses();
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::Book( TTree* streamtree ) const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  if( _eventtree ){ return; }
+
+  // The event tree goes to the current rollover file if any
+  TDirectory* dir = _filelist.empty() ? _dir : _filelist.back().dir;
+
+  TDirectory::TContext context( dir );
+  _eventtree = streamtree->CloneTree( 0 );
+  _eventtree->SetName( "root" );
+  _eventtree->SetTitle( "root" );
+  _eventtree->SetDirectory( dir );
+  ConfigureTree( _eventtree );
+}
+
+/******************************************************************************/
+
+std::shared_future<void>
+NtupleWriter::Fill( TTree* streamtree, const edm::EventID& id ) const
+{
+  if( !_async ){
+    FillTree( streamtree, id );
+    return std::shared_future<void>();
+  }
+
+  FillRequest request( [this, streamtree, id](){ FillTree( streamtree, id ); } );
+  std::shared_future<void> future = request.get_future().share();
+  Enqueue( std::move( request ) );
+  return future;
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillTree( TTree* streamtree, const edm::EventID& id ) const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  if( IsRollover() ){
+    const edm::LuminosityBlockID lumi( id.run(), id.luminosityBlock() );
+
+    if( _fileentries > 0 && ( ( _rolloverevents > 0 && _fileentries >= _rolloverevents )
+                              || ( _rolloversize > 0 && SizeLimitReached() )
+                              || ( _rolloverlumi && lumi != _lastlumi ) ) ){
+      Rollover();
+    }
+
+    _lastlumi = lumi;
+    _fileentries++;
+    _filelist.back().runlist.insert( id.run() );
+  }
+
+  if( streamtree != _lastsource ){
+    CopyAddresses( streamtree, _eventtree );
+    _lastsource = streamtree;
+  }
+
+  const StopWatch watch;
+  _pendingbytes += std::max( _eventtree->Fill(), 0 );
+  _fillstats.WallTime += watch.WallTime();
+  _fillstats.CpuTime  += watch.CpuTime();
+  _fillstats.Calls++;
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillRun( const edm::RunNumber_t run, const RunInfoBranches& runinfo ) const
+{
+  if( !_async ){
+    FillRunTrees( run, runinfo );
+    return;
+  }
+
+  // Queued behind the events of the run that are not written yet
+  auto runinfocopy = std::make_shared<RunInfoBranches>( runinfo );
+  Enqueue( FillRequest( [this, run, runinfocopy](){ FillRunTrees( run, *runinfocopy ); } ) );
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillRunTrees( const edm::RunNumber_t run, const RunInfoBranches& runinfo ) const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _runinfo = runinfo;
+
+  // Lumi counts of the run, all luminosity blocks end before the run
+  const auto counts = _runcounts.find( run );
+  if( counts != _runcounts.end() ){
+    bpk::AddWeightCounts( _runinfo, counts->second );
+    _runcounts.erase( counts );
+  }
+
+  _runtree->Fill();
+
+  // Rollover files holding events of this run, the already closed files are
+  // completed once all their runs are known.
+  for( size_t i = 0; i < _filelist.size(); ){
+    OutputFile& outputfile = _filelist[i];
+
+    if( outputfile.runlist.erase( run ) ){
+      outputfile.runinfolist.push_back( _runinfo );
+    }
+
+    if( !outputfile.file && outputfile.runlist.empty() ){
+      CompleteFile( outputfile );
+      _filelist.erase( _filelist.begin() + i );
+    } else {
+      ++i;
+    }
+  }
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillLumi( const LumiInfoBranches& lumiinfo ) const
+{
+  if( !_async ){
+    FillLumiTree( lumiinfo );
+    return;
+  }
+
+  auto lumiinfocopy = std::make_shared<LumiInfoBranches>( lumiinfo );
+  Enqueue( FillRequest( [this, lumiinfocopy](){ FillLumiTree( *lumiinfocopy ); } ) );
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillLumiTree( const LumiInfoBranches& lumiinfo ) const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _lumiinfo = lumiinfo;
+  _lumitree->Fill();
+
+  bpk::AddWeightCounts( _runcounts[lumiinfo.RunNo], lumiinfo );
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::MergeStats( const std::vector<NtuplizerStats>& statlist ) const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  if( _statlist.empty() ){
+    _statlist.resize( statlist.size() );
+  }
+
+  for( size_t i = 0; i < statlist.size() && i < _statlist.size(); ++i ){
+    _statlist[i].Merge( statlist[i] );
+  }
+}
+
+/*******************************************************************************
+*   Asynchronous filling
+*******************************************************************************/
+void
+NtupleWriter::Enqueue( FillRequest&& request ) const
+{
+  {
+    std::lock_guard<std::mutex> lock( _queuemutex );
+    _queue.push_back( std::move( request ) );
+  }
+  _queuecond.notify_one();
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::FillLoop()
+{
+  while( true ){
+    std::unique_lock<std::mutex> lock( _queuemutex );
+    _queuecond.wait( lock, [this](){ return !_queue.empty() || _stopfilling; } );
+    if( _queue.empty() ){ return; }// Stopped and drained
+
+    FillRequest request = std::move( _queue.front() );
+    _queue.pop_front();
+    lock.unlock();
+
+    // Exceptions are stored in the future of the request
+    request();
+  }
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::StopFillThread()
+{
+  if( !_fillthread.joinable() ){ return; }
+  {
+    std::lock_guard<std::mutex> lock( _queuemutex );
+    _stopfilling = true;
+  }
+  _queuecond.notify_one();
+  _fillthread.join();
+}
+
+/*******************************************************************************
+*   Rollover files
+*******************************************************************************/
+void
+NtupleWriter::ConfigureTree( TTree* tree ) const
+{
+  // Branches cloned from the file-less stream tree do not carry the file
+  // settings, setting them explicitly.
+  const TObjArray* branchlist = tree->GetListOfBranches();
+
+  for( int i = 0; i < branchlist->GetEntriesFast(); ++i ){
+    ( (TBranch*)branchlist->UncheckedAt( i ) )->SetCompressionSettings( _compression );
+  }
+
+  tree->SetAutoFlush( _autoflush );
+
+  // Later entries take precedence for branches matching several patterns
+  for( const auto& basket : _basketsizes ){
+    tree->SetBasketSize( basket.first.c_str(), basket.second );
+  }
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::OpenFile() const
+{
+  const std::string filename = _filebase + "_" + std::to_string( _fileindex++ ) + ".root";
+
+  OutputFile outputfile;
+  outputfile.name = filename;
+  outputfile.file = TFile::Open( filename.c_str(), "RECREATE", "", _compression );
+  if( !outputfile.file || outputfile.file->IsZombie() ){
+    throw cms::Exception( "FileOpenError" ) << "Cannot create output file [" << filename << "]";
+  }
+
+  // Same layout as the TFileService file, readers need no changes
+  outputfile.dir = outputfile.file->mkdir( _dir->GetName() );
+
+  _filelist.push_back( outputfile );
+  _fileentries     = 0;
+  _flushedzipbytes = 0;
+  _pendingbytes    = 0;
+}
+
+/******************************************************************************/
+
+// GetZipBytes() only counts the baskets already written to the file. The
+// uncompressed size of the baskets still in memory is an upper bound of what
+// they add, the baskets are only flushed when this bound reaches the limit.
+bool
+NtupleWriter::SizeLimitReached() const
+{
+  if( _eventtree->GetZipBytes() != _flushedzipbytes ){// Flushed by the auto flush
+    _flushedzipbytes = _eventtree->GetZipBytes();
+    _pendingbytes    = 0;
+  }
+
+  if( _flushedzipbytes + _pendingbytes < _rolloversize ){ return false; }
+
+  _eventtree->FlushBaskets();
+  _flushedzipbytes = _eventtree->GetZipBytes();
+  _pendingbytes    = 0;
+  return _flushedzipbytes >= _rolloversize;
+}
+
+/******************************************************************************/
+
+void
+NtupleWriter::Rollover() const
+{
+  TTree* oldtree = _eventtree;
+  OpenFile();
+
+  TDirectory* dir = _filelist.back().dir;
+  {
+    TDirectory::TContext context( dir );
+    _eventtree = oldtree->CloneTree( 0 );
+    _eventtree->SetDirectory( dir );
+    ConfigureTree( _eventtree );
+    _lastsource = nullptr;
+  }
+
+  // The old file is closed right away, freeing the baskets and the file
+  // handle. Its run tree is written now if all its runs are known.
+  OutputFile& oldfile = _filelist[_filelist.size() - 2];
+  {
+    TDirectory::TContext context( oldfile.dir );
+    oldtree->Write();
+    delete oldtree;
+  }
+
+  CloseFile( oldfile );
+  if( oldfile.runlist.empty() ){
+    _filelist.erase( _filelist.end() - 2 );
+  }
+}
+
+/******************************************************************************/
+
+// A run can span several files, the weight counts of the whole run ( with
+// nSumLHEWeight ) are only in the job wide run tree.
+void
+NtupleWriter::WriteRunTree( OutputFile& outputfile ) const
+{
+  TDirectory::TContext context( outputfile.dir );
+  TTree* runtree = new TTree( "run", "run" );
+
+  RunInfoBranches runinfo;
+  const std::vector<std::string> countlist = { "Events", "SumWeight*", "*SumLHEWeight" };
+  runinfo.RegisterTree( runtree, "RunInfo", bpk::BranchFilter( {}, countlist ) );
+
+  for( const auto& completed : outputfile.runinfolist ){
+    runinfo = completed;
+    runtree->Fill();
+  }
+
+  runtree->Write();
+  delete runtree;
+  outputfile.runinfolist.clear();
+}
+
+/******************************************************************************/
+
+// Closing the open file, with its run tree if all its runs are known
+void
+NtupleWriter::CloseFile( OutputFile& outputfile ) const
+{
+  if( outputfile.runlist.empty() ){
+    WriteRunTree( outputfile );
+  }
+
+  outputfile.file->Write();
+  outputfile.file->Close();
+  delete outputfile.file;
+  outputfile.file = nullptr;
+  outputfile.dir  = nullptr;
+}
+
+/******************************************************************************/
+
+// Reopening a closed file to add its run tree
+void
+NtupleWriter::CompleteFile( OutputFile& outputfile ) const
+{
+  outputfile.file = TFile::Open( outputfile.name.c_str(), "UPDATE" );
+  if( !outputfile.file || outputfile.file->IsZombie() ){
+    throw cms::Exception( "FileOpenError" ) << "Cannot reopen output file [" << outputfile.name << "]";
+  }
+
+  outputfile.dir = outputfile.file->GetDirectory( _dir->GetName() );
+  CloseFile( outputfile );
+}
+
+/*******************************************************************************
+*   Helper functions
+*******************************************************************************/
+
+// Mapping the algorithm name to the ROOT compression settings (100*algorithm +
+// level). LZ4 and ZSTD are only known to newer ROOT versions, older versions
+// silently fall back to the default algorithm.
+int
+NtupleWriter::CompressionSettings( const std::string& algorithm, const int level )
+{
+  static const std::vector<std::pair<std::string, int> > algolist = {
+    { "ZLIB", 1 },
+    { "LZMA", 2 },
+    { "LZ4",  4 },
+    { "ZSTD", 5 },
+  };
+
+  for( const auto& algo : algolist ){
+    if( algo.first == algorithm ){
+      return 100 * algo.second + level;
+    }
+  }
+
+  cerr << "Unknown compression algorithm [" << algorithm << "], using ZLIB" << endl;
+  return 100 + level;
+}
+
+/******************************************************************************/
+
+// Same as TTree::CopyAddresses, but pairing the branches by position rather than
+// by name lookup: every stream tree is registered by the same ntuplizer list in
+// the same order, so the top level branch lists are identical.
+void
+NtupleWriter::CopyAddresses( TTree* source, TTree* target )
+{
+  const TObjArray* sourcebranches = source->GetListOfBranches();
+  const TObjArray* targetbranches = target->GetListOfBranches();
+
+  for( int i = 0; i < sourcebranches->GetEntriesFast(); ++i ){
+    TBranch* sourcebranch = (TBranch*)sourcebranches->UncheckedAt( i );
+    TBranch* targetbranch = (TBranch*)targetbranches->UncheckedAt( i );
+    targetbranch->SetAddress( sourcebranch->GetAddress() );
+  }
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+*
+*  Filename    : NtuplizerStats.cc
+*  Description : Implementation of the ntuplizer counters and timers
+*
+*******************************************************************************/
+#include "bpkFrameWork/bprimeKit/interface/NtuplizerStats.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+/*******************************************************************************
+*   NtuplizerStats
+*******************************************************************************/
+NtuplizerStats::NtuplizerStats( const std::string& name ) :
+  Name( name ),
+  Calls( 0 ),
+  WallTime( 0 ),
+  CpuTime( 0 ),
+  RegisterTime( 0 ),
+  RegisterCpuTime( 0 ),
+  ObjSeen( 0 ),
+  ObjStored( 0 ),
+  EvtSeen( 0 ),
+  EvtStored( 0 )
+{
+}
+
+/******************************************************************************/
+
+void
+NtuplizerStats::Merge( const NtuplizerStats& x )
+{
+  if( Name.empty() ){ Name = x.Name; }
+  Calls           += x.Calls;
+  WallTime        += x.WallTime;
+  CpuTime         += x.CpuTime;
+  RegisterTime    += x.RegisterTime;
+  RegisterCpuTime += x.RegisterCpuTime;
+  ObjSeen         += x.ObjSeen;
+  ObjStored       += x.ObjStored;
+  EvtSeen         += x.EvtSeen;
+  EvtStored       += x.EvtStored;
+}
+
+/******************************************************************************/
+
+void
+NtuplizerStats::PrintTable( std::ostream& out, const std::vector<NtuplizerStats>& statlist )
+{
+  double totalwall = 0;
+
+  for( const auto& stat : statlist ){
+    totalwall += stat.WallTime;
+  }
+
+  out << "================ bprimeKit ntuplizer summary ================" << endl;
+  out << left  << setw( 24 ) << "Ntuplizer"
+      << right << setw( 10 ) << "Calls"
+      << setw( 12 ) << "Wall [s]"
+      << setw( 12 ) << "CPU [s]"
+      << setw( 8 )  << "Wall %"
+      << setw( 12 ) << "ms/call"
+      << setw( 12 ) << "Seen"
+      << setw( 12 ) << "Stored"
+      << endl;
+
+  for( const auto& stat : statlist ){
+    out << left  << setw( 24 ) << stat.Name
+        << right << setw( 10 ) << stat.Calls
+        << fixed << setprecision( 3 )
+        << setw( 12 ) << stat.WallTime
+        << setw( 12 ) << stat.CpuTime
+        << setprecision( 1 )
+        << setw( 8 ) << ( totalwall > 0 ? 100. * stat.WallTime / totalwall : 0. )
+        << setprecision( 3 )
+        << setw( 12 ) << ( stat.Calls ? 1000. * stat.WallTime / stat.Calls : 0. )
+        << setw( 12 ) << stat.ObjSeen
+        << setw( 12 ) << stat.ObjStored
+        << endl;
+  }
+
+  for( const auto& stat : statlist ){
+    if( stat.EvtSeen == 0 ){ continue; }
+    out << stat.Name << ": " << stat.EvtStored << " of " << stat.EvtSeen << " events passed" << endl;
+  }
+
+  out << "=============================================================" << endl;
+}
+
+/*******************************************************************************
+*   StopWatch
+*******************************************************************************/
+StopWatch::StopWatch() :
+  _wallstart( std::chrono::steady_clock::now() )
+{
+  clock_gettime( CLOCK_THREAD_CPUTIME_ID, &_cpustart );
+}
+
+/******************************************************************************/
+
+double
+StopWatch::WallTime() const
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - _wallstart ).count();
+}
+
+/******************************************************************************/
+
+double
+StopWatch::CpuTime() const
+{
+  timespec now;
+  clock_gettime( CLOCK_THREAD_CPUTIME_ID, &now );
+  return ( now.tv_sec - _cpustart.tv_sec ) + 1e-9 * ( now.tv_nsec - _cpustart.tv_nsec );
+}
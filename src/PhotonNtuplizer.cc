@@ -42,7 +42,15 @@ PhotonNtuplizer::~PhotonNtuplizer()
 void
 PhotonNtuplizer::RegisterTree( TTree* tree )
 {
-  PhotonInfo.RegisterTree( tree, _photonname );
+  PhotonInfo.RegisterTree( tree, _photonname, OutputFilter() );
+}
+
+/******************************************************************************/
+
+std::string
+PhotonNtuplizer::Name() const
+{
+  return _photonname;
 }
 
 
@@ -50,7 +58,7 @@ PhotonNtuplizer::RegisterTree( TTree* tree )
 *   Main loop
 *******************************************************************************/
 void
-PhotonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+PhotonNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
   iEvent.getByToken( _rhotoken,                      _rhohandle                 );
   iEvent.getByToken( _photontoken,                   _photonhandle              );
@@ -61,8 +69,14 @@ PhotonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetu
   iEvent.getByToken( _photonIsolation_Neutral_Token, _photonIsolation_Neutral_H );
   iEvent.getByToken( _photonIsolation_Photon_Token,  _photonIsolation_Photon_H  );
   iEvent.getByToken( _photonSignaIEtaIEtaToken,      _photonSigmaIEtaIEta_H     );
+}
 
-  memset( &PhotonInfo, 0x00, sizeof( PhotonInfo ) );
+/******************************************************************************/
+
+void
+PhotonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  PhotonInfo.Reset();
 
   for( auto it_pho = _photonhandle->begin(); it_pho != _photonhandle->end(); it_pho++ ){
     if( PhotonInfo.Size >= MAX_PHOTONS ){
@@ -130,4 +144,6 @@ PhotonNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetu
     }
     PhotonInfo.Size++;
   }
+
+  CountObjects( _photonhandle->size(), PhotonInfo.Size );
 }
@@ -0,0 +1,8 @@
+/*******************************************************************************
+*
+*  Filename    : TriggerBooking.cc
+*  Description : Single definition of the TriggerBooking name table
+*
+*******************************************************************************/
+#define BPK_TRIGGERBOOKING_TABLE
+#include "bpkFrameWork/bprimeKit/interface/TriggerBooking.h"
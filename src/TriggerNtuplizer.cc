@@ -7,7 +7,7 @@
 *******************************************************************************/
 #include "DataFormats/HLTReco/interface/TriggerTypeDefs.h"
 #include "bpkFrameWork/bprimeKit/interface/TriggerNtuplizer.hpp"
-#include <regex>
+#include <algorithm>
 using namespace std;
 
 /*******************************************************************************
@@ -16,7 +16,8 @@ using namespace std;
 TriggerNtuplizer::TriggerNtuplizer( const edm::ParameterSet& iConfig, bprimeKit* bpk ):
   NtuplizerBase( iConfig, bpk ),
   _triggertoken( GetToken<edm::TriggerResults>("triggersrc") ),
-  _triggerobjtoken( GetToken<std::vector<pat::TriggerObjectStandAlone>>("triggerobjsrc") )
+  _triggerobjtoken( GetToken<std::vector<pat::TriggerObjectStandAlone>>("triggerobjsrc") ),
+  _trgnames( nullptr )
 {
 
   for( const auto& paramset : iConfig.getParameter<std::vector<edm::ParameterSet> >( "triggerlist" ) ){
@@ -24,6 +25,7 @@ TriggerNtuplizer::TriggerNtuplizer( const edm::ParameterSet& iConfig, bprimeKit*
     mypair.first  = paramset.getParameter<std::string>( "HLTPath" );
     mypair.second = paramset.getParameter<std::string>( "HLTFilter" );
     _triggerlist.push_back( mypair );
+    _matcherlist.emplace_back( std::regex( GlobToRegex( mypair.first ) ), std::regex( GlobToRegex( mypair.second ) ) );
   }
 }
 
@@ -40,40 +42,80 @@ TriggerNtuplizer::~TriggerNtuplizer()
 void
 TriggerNtuplizer::RegisterTree( TTree* tree )
 {
-  TrgInfo.RegisterTree( tree );
+  TrgInfo.RegisterTree( tree, "TrgInfo", OutputFilter() );
+}
+
+/******************************************************************************/
+
+std::string
+TriggerNtuplizer::Name() const
+{
+  return "TrgInfo";
 }
 
 /******************************************************************************/
 
 void
-TriggerNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+TriggerNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
   iEvent.getByToken( _triggertoken, _triggerhandle );
   iEvent.getByToken( _triggerobjtoken, _triggerobjhandle );
 
-  const edm::TriggerNames& TrgNames = iEvent.triggerNames( *_triggerhandle );
+  _trgnames = &iEvent.triggerNames( *_triggerhandle );
+}
+
+/******************************************************************************/
+
+void
+TriggerNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  const edm::TriggerNames& TrgNames = *_trgnames;
+
+  if( TrgNames.parameterSetID() != _triggermenuid ){
+    UpdatePathMatches( TrgNames );
+  }
+
+  TrgInfo.Reset();
+
+  for( const auto& obj : UnpackedObjects( TrgNames ) ){
+    // Paths and filters of the object matching any entry, in the object order
+    _objpathlist.clear();
+
+    for( const auto& objpath : obj.pathNames() ){
+      const unsigned pathidx = TrgNames.triggerIndex( objpath );
+      if( pathidx >= _pathmatchlist.size() ){ continue; }
+      const GlobMatch& match = _pathmatchlist[pathidx];
+      if( match.any && obj.hasPathName( objpath ) ){
+        _objpathlist.push_back( &match );
+      }
+    }
+
+    if( _objpathlist.empty() ){ continue; }
 
-  memset( &TrgInfo, 0x00, sizeof( TrgInfo ) );
+    _objfilterlist.clear();
 
-  for( auto obj : *_triggerobjhandle ){
-    obj.unpackPathNames( TrgNames );
+    for( const auto& objfilter : obj.filterLabels() ){
+      const GlobMatch& match = FilterMatch( objfilter );
+      if( match.any && obj.hasFilterLabel( objfilter ) ){
+        _objfilterlist.push_back( &match );
+      }
+    }
 
-    for( const auto& hltpair : _triggerlist ){
+    for( size_t i = 0; i < _triggerlist.size(); ++i ){
       if( TrgInfo.Size >= 64 ){ break; }
 
-      std::string matchedpath   = "";
-      std::string matchedfilter = "";
-      bool matchresult          = TrigObjMatchPathFilter(
-        obj,
-        hltpair.first, matchedpath,
-        hltpair.second, matchedfilter
-        );
-      if( !matchresult ){ continue; }
+      // First matching path and filter of the object, as integer tests
+      const auto matchedpath = std::find_if( _objpathlist.begin(), _objpathlist.end(),
+        [i]( const GlobMatch* x ){ return x->entrylist[i]; } );
+      const auto matchedfilter = std::find_if( _objfilterlist.begin(), _objfilterlist.end(),
+        [i]( const GlobMatch* x ){ return x->entrylist[i]; } );
+      if( matchedpath == _objpathlist.end() || matchedfilter == _objfilterlist.end() ){ continue; }
+
       TrgInfo.Pt        [TrgInfo.Size] = obj.pt();
       TrgInfo.Eta       [TrgInfo.Size] = obj.eta();
       TrgInfo.Phi       [TrgInfo.Size] = obj.phi();
       TrgInfo.Energy    [TrgInfo.Size] = obj.energy();
-      TrgInfo.TriggerBit[TrgInfo.Size] = bprimeKit::GetTriggerIdx( matchedpath );
+      TrgInfo.TriggerBit[TrgInfo.Size] = ( *matchedpath )->bookingidx;
 
       for( const auto& filterid : obj.filterIds() ){
         TrgInfo.FilterLabel[TrgInfo.Size] *= 100;
@@ -83,6 +125,8 @@ TriggerNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSet
       TrgInfo.Size++;
     }
   }
+
+  CountObjects( _triggerobjhandle->size(), TrgInfo.Size );
 }
 
 
@@ -90,39 +134,74 @@ TriggerNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSet
 *   Helper functions implementations
 *******************************************************************************/
 
-bool
-TriggerNtuplizer::TrigObjMatchPathFilter(
-  const pat::TriggerObjectStandAlone& obj,
-  const std::string&                  path,
-  std::string&                        matchedpath,
-  const std::string&                  filter,
-  std::string&                        matchedfilter
-  )
+// The MiniAOD objects store the path indices only, the names are unpacked once
+// per event into the side list, at the index of the object in the collection.
+// Only the public unpackPathNames() is used, which checks that the indices are
+// of the current menu. The list is reused across events, so copying into it
+// mostly recycles the already allocated vectors and strings. Objects which are
+// already unpacked are used directly, without any copy. The unpacked names are
+// matched through the per-menu _pathmatchlist.
+const std::vector<pat::TriggerObjectStandAlone>&
+TriggerNtuplizer::UnpackedObjects( const edm::TriggerNames& TrgNames )
 {
-  bool hasmatchpath   = false;
-  bool hasmatchfilter = false;
+  const auto& objlist = *_triggerobjhandle;
 
-  const std::regex pathreg( GlobToRegex( path ) );
+  const bool packed = std::any_of( objlist.begin(), objlist.end(),
+    []( const pat::TriggerObjectStandAlone& x ){ return !x.checkIfPathsAreUnpacked( false ); } );
+  if( !packed ){ return objlist; }
 
-  for( const auto& objpath : obj.pathNames() ){
-    if( std::regex_match( objpath, pathreg ) && obj.hasPathName( objpath ) ){
-      hasmatchpath = true;
-      matchedpath  = objpath;
-      break;
-    }
+  _unpackedobjlist.resize( objlist.size() );
+
+  for( size_t i = 0; i < objlist.size(); ++i ){
+    _unpackedobjlist[i] = objlist[i];
+    _unpackedobjlist[i].unpackPathNames( TrgNames );
   }
 
-  const std::regex filterreg( GlobToRegex( filter ) );
+  return _unpackedobjlist;
+}
+
+/******************************************************************************/
 
-  for( const auto& objfilter : obj.filterLabels() ){
-    if( std::regex_match( objfilter, filterreg ) && obj.hasFilterLabel( objfilter ) ){
-      hasmatchfilter = true;
-      matchedfilter  = objfilter;
-      break;
+// Matching every path of a new HLT menu against the triggerlist, so the
+// objects are matched by path index only.
+void
+TriggerNtuplizer::UpdatePathMatches( const edm::TriggerNames& TrgNames )
+{
+  _triggermenuid = TrgNames.parameterSetID();
+  _filtercache.clear();
+  _pathmatchlist.assign( TrgNames.size(), GlobMatch() );
+
+  for( unsigned i = 0; i < TrgNames.size(); ++i ){
+    const std::string& path = TrgNames.triggerName( i );
+    GlobMatch& match        = _pathmatchlist[i];
+    match.any        = false;
+    match.bookingidx = bprimeKit::GetTriggerIdx( path );
+
+    for( const auto& matcher : _matcherlist ){
+      match.entrylist.push_back( std::regex_match( path, matcher.first ) );
+      match.any |= match.entrylist.back();
     }
   }
+}
+
+/******************************************************************************/
+
+const TriggerNtuplizer::GlobMatch&
+TriggerNtuplizer::FilterMatch( const std::string& filter )
+{
+  const auto found = _filtercache.find( filter );
+  if( found != _filtercache.end() ){ return found->second; }
+
+  GlobMatch& match = _filtercache[filter];
+  match.any        = false;
+  match.bookingidx = -1;
+
+  for( const auto& matcher : _matcherlist ){
+    match.entrylist.push_back( std::regex_match( filter, matcher.second ) );
+    match.any |= match.entrylist.back();
+  }
 
-  return hasmatchpath && hasmatchfilter;
+  return match;
 }
 
 /******************************************************************************/
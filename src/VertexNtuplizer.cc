@@ -32,18 +32,32 @@ VertexNtuplizer::~VertexNtuplizer()
 void
 VertexNtuplizer::RegisterTree( TTree* tree )
 {
-  VertexInfo.RegisterTree( tree );
+  VertexInfo.RegisterTree( tree, "VertexInfo", OutputFilter() );
+}
+
+/******************************************************************************/
+
+std::string
+VertexNtuplizer::Name() const
+{
+  return "VertexInfo";
 }
 
 /******************************************************************************/
 
 
 void
-VertexNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+VertexNtuplizer::GetHandles( const edm::Event& iEvent, const edm::EventSetup& iSetup )
 {
   iEvent.getByToken( _vtxtoken,   _vtxhandle   );
+}
 
-  memset( &VertexInfo, 0x00, sizeof( VertexInfo ) );
+/******************************************************************************/
+
+void
+VertexNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetup )
+{
+  VertexInfo.Reset();
 
   // ----- Vertices without beamspot constraints  -----------------------------------------------------
   for( auto it_vtx = _vtxhandle->begin(); it_vtx != _vtxhandle->end(); ++it_vtx ){
@@ -70,4 +84,6 @@ VertexNtuplizer::Analyze( const edm::Event& iEvent, const edm::EventSetup& iSetu
 
     VertexInfo.Size++;
   }
+
+  CountObjects( _vtxhandle->size(), VertexInfo.Size );
 }
@@ -12,8 +12,51 @@
 #include "DataFormats/Math/interface/deltaR.h"
 #include "bpkFrameWork/bprimeKit/interface/bprimeKit.hpp"
 #include <iostream>
+#include <vector>
 using namespace std;
 
+namespace {
+
+// Tag contribution of a single ancestor, see GetGenMCTag
+inline int
+AncestorTag( const int pdgid )
+{
+  const int id = abs( pdgid );
+  return
+    id                    == 23 ? 2 :
+    id                    == 24 ? 1 :
+    id                    == 5  ? 3 :  // from a b quark
+    ( id % 1000 ) / 100   == 5  ? 3 :  // from a B meson
+    ( id % 10000 ) / 1000 == 5  ? 3 :   // from a bottom baryon
+    id                    == 4  ? 4 :  // from a c quark
+    ( id % 1000 ) / 100   == 4  ? 4 :  // from a D meson
+    ( id % 10000 ) / 1000 == 4  ? 4 :   // from a charm baryon
+    id                    == 15 ? 7 :  // from tau
+    0;
+}
+
+inline int
+BprimeTag( const int pdgid )
+{
+  return
+    abs( pdgid ) == 7 ? 1 : // check if it's bprime
+    abs( pdgid ) == 8 ? 2 : // check if it's tprime.
+    0;
+}
+
+// Tag of a particle from its mother and the tag of the mother: the nearest
+// ancestor tag and the farthest b'/t' tag of the single mother chain
+inline int
+CombineTag( const reco::Candidate* mother, const int mothertag )
+{
+  const int ancestortag = AncestorTag( mother->pdgId() );
+  const int returnTag   = ancestortag ? ancestortag : mothertag % 10;
+  const int bprimeTag   = mothertag / 10 ? mothertag / 10 : BprimeTag( mother->pdgId() );
+  return returnTag + 10 * bprimeTag;
+}
+
+}
+
 /*******************************************************************************
 *   Common method for getting pat::Muon, pat::Jet, and pat::Electron gen tag
 *******************************************************************************/
@@ -26,23 +69,10 @@ bprimeKit::GetGenMCTag( const reco::GenParticle* gen )
 
   while( genCand != NULL && genCand->numberOfMothers() == 1 ){
     genCand   = genCand->mother( 0 );
-    bprimeTag =
-      abs( genCand->pdgId() ) == 7 ? 1 : // check if it's bprime
-      abs( genCand->pdgId() ) == 8 ? 2 : // check if it's tprime.
-      bprimeTag;
+    bprimeTag = BprimeTag( genCand->pdgId() ) ? BprimeTag( genCand->pdgId() ) : bprimeTag;
 
     if( returnTag == 0 ){
-      returnTag =
-        abs( genCand->pdgId() )                    == 23 ? 2 :
-        abs( genCand->pdgId() )                    == 24 ? 1 :
-        abs( genCand->pdgId() )                    == 5  ? 3 :  // from a b quark
-        ( abs( genCand->pdgId() ) % 1000 ) / 100   == 5  ? 3 :  // from a B meson
-        ( abs( genCand->pdgId() ) % 10000 ) / 1000 == 5  ? 3 :   // from a bottom baryon
-        abs( genCand->pdgId() )                    == 4  ? 4 :  // from a c quark
-        ( abs( genCand->pdgId() ) % 1000 ) / 100   == 4  ? 4 :  // from a D meson
-        ( abs( genCand->pdgId() ) % 10000 ) / 1000 == 4  ? 4 :   // from a charm baryon
-        abs( genCand->pdgId() )                    == 15 ? 7 :  // from tau
-        0;
+      returnTag = AncestorTag( genCand->pdgId() );
     }
   }
 
@@ -50,18 +80,57 @@ bprimeKit::GetGenMCTag( const reco::GenParticle* gen )
   return returnTag;
 }
 
-
 /******************************************************************************/
-std::map<std::string,int> bprimeKit::_hltmap;
 
 int
-bprimeKit::GetTriggerIdx( const string& triggername )
+bprimeKit::GetGenMCTag( const reco::Candidate* gen, GenMCTagCache& cache )
+{
+  if( gen == NULL ){ return 0; }
+
+  // Walking up to the first ancestor with a known tag, or the end of the
+  // single mother chain
+  std::vector<const reco::Candidate*> chain;
+  const reco::Candidate* genCand = gen;
+  int tag                        = 0;
+
+  while( true ){
+    const auto found = cache.find( genCand );
+    if( found != cache.end() ){
+      tag = found->second;
+      break;
+    }
+    if( genCand->numberOfMothers() != 1 ){
+      cache.emplace( genCand, 0 );
+      break;
+    }
+    chain.push_back( genCand );
+    genCand = genCand->mother( 0 );
+  }
+
+  // Tagging the walked particles from the top down
+  for( auto it = chain.rbegin(); it != chain.rend(); ++it ){
+    tag = CombineTag( genCand, tag );
+    cache.emplace( *it, tag );
+    genCand = *it;
+  }
+
+  return tag;
+}
+
+/******************************************************************************/
+
+std::vector<int>
+bprimeKit::GetGenMCTags( const std::vector<reco::GenParticle>& genlist )
 {
-  const auto& result = _hltmap.find( triggername  );
-  if( result != _hltmap.end() ){
-    return result->second;
-  } else {
-    // cout << "Cannot find trigger index for " << triggername << endl;
-    return -1;
+  GenMCTagCache cache;
+  cache.reserve( genlist.size() );
+
+  std::vector<int> ans;
+  ans.reserve( genlist.size() );
+
+  for( const auto& gen : genlist ){
+    ans.push_back( GetGenMCTag( &gen, cache ) );
   }
+
+  return ans;
 }
@@ -0,0 +1,116 @@
+/*******************************************************************************
+*
+*  Filename    : bprimeKit_Util_Trigger.cc
+*  Description : Trigger name to TriggerBooking index lookup
+*
+*  Details     : The booked names are stored in an open addressing hash table
+*                (64 bit FNV-1a, linear probing, load factor < 0.5), built once
+*                on first use and read-only afterwards (shared by all streams).
+*                A lookup hashes the name once and typically compares a single
+*                entry, without any allocation.
+*
+*******************************************************************************/
+#include "bpkFrameWork/bprimeKit/interface/bprimeKit.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+inline uint64_t
+TriggerHash( const char* name, const size_t length )
+{
+  uint64_t hash = 14695981039346656037ull;
+
+  for( size_t i = 0; i < length; ++i ){
+    hash ^= (unsigned char)name[i];
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+struct TriggerHashEntry {
+  uint64_t hash;
+  int      index;// -1 for empty slots
+};
+
+const std::vector<TriggerHashEntry>&
+TriggerHashTable()
+{
+  static const std::vector<TriggerHashEntry> table = [](){
+    size_t size = 1;
+
+    while( size < 2 * N_TRIGGER_BOOKINGS ){
+      size <<= 1;
+    }
+
+    std::vector<TriggerHashEntry> ans( size, TriggerHashEntry{ 0, -1 } );
+
+    for( int i = 0; i < N_TRIGGER_BOOKINGS; ++i ){
+      const uint64_t hash = TriggerHash( TriggerBooking[i], strlen( TriggerBooking[i] ) );
+      size_t slot         = hash & ( size - 1 );
+
+      while( ans[slot].index >= 0 ){
+        // Keeping the first booking of duplicated names, as std::map::insert did
+        if( ans[slot].hash == hash && strcmp( TriggerBooking[ans[slot].index], TriggerBooking[i] ) == 0 ){ break; }
+        slot = ( slot + 1 ) & ( size - 1 );
+      }
+
+      if( ans[slot].index < 0 ){
+        ans[slot] = TriggerHashEntry{ hash, i };
+      }
+    }
+
+    return ans;
+  }();
+
+  return table;
+}
+
+}
+
+/******************************************************************************/
+
+int
+bprimeKit::GetTriggerIdx( const string& triggername )
+{
+  const auto& table   = TriggerHashTable();
+  const uint64_t hash = TriggerHash( triggername.data(), triggername.size() );
+  const size_t mask   = table.size() - 1;
+
+  for( size_t slot = hash & mask; table[slot].index >= 0; slot = ( slot + 1 ) & mask ){
+    if( table[slot].hash == hash && triggername.compare( TriggerBooking[table[slot].index] ) == 0 ){
+      return table[slot].index;
+    }
+  }
+
+  // cout << "Cannot find trigger index for " << triggername << endl;
+  return -1;
+}
+
+/******************************************************************************/
+
+// Index in bpk::TriggerFamilyList() of a versionless path name (see
+// bpk::TriggerFamily), -1 if not booked. Only used when the menu changes.
+int
+bprimeKit::GetTriggerFamilyIdx( const string& family )
+{
+  static const std::unordered_map<std::string, int> familymap = [](){
+    std::unordered_map<std::string, int> ans;
+    const auto& familylist = bpk::TriggerFamilyList();
+
+    for( size_t i = 0; i < familylist.size(); ++i ){
+      ans.emplace( familylist[i], i );
+    }
+
+    return ans;
+  }();
+
+  const auto result = familymap.find( family );
+  return result != familymap.end() ? result->second : -1;
+}
@@ -7,22 +7,89 @@
 *******************************************************************************/
 #include "bpkFrameWork/bprimeKit/interface/bprimeKit.hpp"
 
+#include <exception>
 #include <iostream>
+#include <string>
 
 using namespace std;
 
 void
-bprimeKit::FillRunInfo()
+bprimeKit::FillRunInfo( const edm::Run& iRun, RunInfoBranches& runinfo ) const
 {
-  if( _runinfohandle.isValid() ){
-    RunInfo.PdfID = _runinfohandle->heprup().PDFSUP.first;
+  // Every stream calls this at the end of the run, only the first one fills
+  if( runinfo.RunNo == int( iRun.run() ) ){ return; }
+  runinfo.RunNo = iRun.run();
+
+  edm::Handle<LHERunInfoProduct> runinfohandle;
+  iRun.getByToken<LHERunInfoProduct>( _lheruntoken, runinfohandle );
+
+  if( runinfohandle.isValid() ){
+    runinfo.PdfID = runinfohandle->heprup().PDFSUP.first;
+    FillLHEWeightInfo( *runinfohandle, runinfo );
   } else {
     cerr << "Invalid handle!" << endl;
   }
 }
 
+/******************************************************************************/
+
+namespace {
+
+// Value of the attribute in an XML tag, ex. id="1001" -> 1001
+std::string
+XmlAttribute( const std::string& tag, const std::string& attribute )
+{
+  for( const char quote : { '"', '\'' } ){
+    const std::string key = attribute + "=" + quote;
+    const size_t begin    = tag.find( key );
+    if( begin == std::string::npos ){ continue; }
+    const size_t end = tag.find( quote, begin + key.size() );
+    if( end == std::string::npos ){ continue; }
+    return tag.substr( begin + key.size(), end - begin - key.size() );
+  }
+
+  return "";
+}
+
+}
+
+/******************************************************************************/
+
+// Weight IDs and groups listed in the <initrwgt> header, in the order of the
+// weights stored in the events (LHEEventProduct::weights()).
 void
-bprimeKit::GetRunObjects( const edm::Run& iRun, const edm::EventSetup& iSetup )
+bprimeKit::FillLHEWeightInfo( const LHERunInfoProduct& lherun, RunInfoBranches& runinfo ) const
 {
-  iRun.getByToken<LHERunInfoProduct>( _lheruntoken, _runinfohandle );
+  int group = -1;
+
+  for( auto header = lherun.headers_begin(); header != lherun.headers_end(); ++header ){
+    if( header->tag() != "initrwgt" ){ continue; }
+
+    for( const auto& line : header->lines() ){
+      for( size_t begin = line.find( '<' ); begin != std::string::npos; begin = line.find( '<', begin + 1 ) ){
+        const size_t end = line.find( '>', begin );
+        if( end == std::string::npos ){ break; }
+        const std::string tag = line.substr( begin, end - begin + 1 );
+
+        if( tag.compare( 0, 12, "<weightgroup" ) == 0 ){
+          std::string name = XmlAttribute( tag, "name" );
+          if( name.empty() ){ name = XmlAttribute( tag, "type" ); }
+          group = runinfo.LHEWeightGroupName_w.size();
+          runinfo.LHEWeightGroupName_w.push_back( name );
+        } else if( tag.compare( 0, 14, "</weightgroup>" ) == 0 ){
+          group = -1;
+        } else if( tag.compare( 0, 8, "<weight " ) == 0 && runinfo.nLHEWeight < MAX_LHE ){
+          int id = -1;
+          try {
+            id = std::stoi( XmlAttribute( tag, "id" ) );
+          } catch( const std::exception& ){
+            cerr << "Non-numeric LHE weight ID in [" << tag << "]" << endl;
+          }
+          runinfo.LHEWeightId[runinfo.nLHEWeight]    = id;
+          runinfo.LHEWeightGroup[runinfo.nLHEWeight] = group;
+          ++runinfo.nLHEWeight;
+        }
+      }
+    }
+  }
 }
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string.h>
 
+#define BPK_TRIGGERBOOKING_TABLE// Single reader file, defining the name table here
 #include "TriggerBooking.h"
 #include "format.h"
 
@@ -39,6 +40,7 @@ checkoutput()
 
   for( int entry = 0; entry < root->GetEntries() && entry < 5; ++entry ){
     root->GetEntry( entry );
+    EvtInfo.UnpackTrigger( root );
 
     cout << "\nentry = "<< entry << endl;
 
@@ -62,7 +64,7 @@ checkoutput()
     for( int j = 0; j < TrgInfo.Size; ++j ){
       printf( "%4d | %40s | %8d | %6lf %6lf %6lf\n",
         TrgInfo.TriggerBit[j],
-        TriggerBooking[ TrgInfo.TriggerBit[j]].c_str(),
+        TriggerBooking[ TrgInfo.TriggerBit[j]],
         TrgInfo.FilterLabel[j],
         TrgInfo.Pt[j], TrgInfo.Eta[j], TrgInfo.Phi[j]
         );